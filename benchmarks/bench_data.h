@@ -0,0 +1,45 @@
+#pragma once
+#include "query_engine/executor.h"
+#include "storage_engine/table_manager.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Данные для бенчмарков генерируются на месте, с фиксированным seed:
+// прогоны на разных сборках сравнимы, сеть и файлы не нужны.
+namespace BenchData {
+    constexpr uint64_t kSeed = 42;
+
+    // Колонки id (int64, подряд), key (int64 в [0, key_range)), amount (double), name (string)
+    inline ResultSet rows(size_t count, uint64_t key_range, uint64_t seed = kSeed) {
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<uint64_t> key(0, key_range - 1);
+        std::uniform_real_distribution<double> amount(0.0, 1000.0);
+        ResultSet result;
+        result.columns = {"id", "key", "amount", "name"};
+        result.rows.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            result.rows.push_back({static_cast<int64_t>(i), static_cast<int64_t>(key(rng)), amount(rng),
+                                   "customer#" + std::to_string(key(rng))});
+        }
+        return result;
+    }
+
+    inline std::vector<ColumnSpec> schema() {
+        return {{"id", ColumnType::Int64},
+                {"key", ColumnType::Int64},
+                {"amount", ColumnType::Double},
+                {"name", ColumnType::String}};
+    }
+
+    // Таблица со схемой schema() и строками rows(count, key_range)
+    inline std::shared_ptr<ColumnarTable> table(TableManager& tables, const std::string& name, size_t count,
+                                                uint64_t key_range) {
+        auto table = tables.createTable(name, schema());
+        for (const Row& row : rows(count, key_range).rows) table->appendRow(row);
+        return table;
+    }
+}
@@ -0,0 +1,94 @@
+#include "bench_data.h"
+#include "query_engine/executor.h"
+#include "query_engine/sql_engine.h"
+#include <benchmark/benchmark.h>
+
+namespace {
+    // Вход join'а: build — range(0) строк с уникальными ключами, probe — вчетверо больше,
+    // каждая строка находит пару
+    struct JoinInput {
+        ResultSet build;
+        ResultSet probe;
+    };
+
+    JoinInput joinInput(size_t build_rows) {
+        JoinInput input;
+        input.build = BenchData::rows(build_rows, build_rows);
+        for (size_t i = 0; i < build_rows; ++i) input.build.rows[i][1] = static_cast<int64_t>(i);
+        input.probe = BenchData::rows(build_rows * 4, build_rows, BenchData::kSeed + 1);
+        return input;
+    }
+
+    // Радикс-партиционированный join против цепочечного: сравнение держит
+    // порог kSimpleJoinThreshold честным
+    void BM_HashJoinRadix(benchmark::State& state) {
+        const JoinInput input = joinInput(state.range(0));
+        const QueryExecutor executor;
+        for (auto _ : state) benchmark::DoNotOptimize(executor.hashJoin(input.probe, 1, input.build, 1));
+        state.SetItemsProcessed(state.iterations() * (input.probe.rows.size() + input.build.rows.size()));
+    }
+
+    void BM_HashJoinSimple(benchmark::State& state) {
+        const JoinInput input = joinInput(state.range(0));
+        const QueryExecutor executor;
+        for (auto _ : state) benchmark::DoNotOptimize(executor.simpleHashJoin(input.probe, 1, input.build, 1));
+        state.SetItemsProcessed(state.iterations() * (input.probe.rows.size() + input.build.rows.size()));
+    }
+
+    // GROUP BY key с SUM и COUNT; range(1) — число групп
+    void BM_HashAggregate(benchmark::State& state) {
+        const ResultSet input = BenchData::rows(state.range(0), state.range(1));
+        const QueryExecutor executor;
+        const std::vector<AggregateSpec> aggregates = {{AggregateFunction::Sum, 2, ""},
+                                                       {AggregateFunction::Count, kStarColumn, ""}};
+        for (auto _ : state) benchmark::DoNotOptimize(executor.hashAggregate(input, {1}, aggregates));
+        state.SetItemsProcessed(state.iterations() * input.rows.size());
+    }
+
+    void BM_SortInMemory(benchmark::State& state) {
+        const ResultSet input = BenchData::rows(state.range(0), 1u << 30);
+        const QueryExecutor executor;
+        for (auto _ : state) {
+            state.PauseTiming();
+            ResultSet copy = input;
+            state.ResumeTiming();
+            benchmark::DoNotOptimize(executor.sort(std::move(copy), {{2, true}, {0, false}}));
+        }
+        state.SetItemsProcessed(state.iterations() * input.rows.size());
+    }
+
+    // Полный путь SELECT через SqlEngine: разбор, план, колоночный скан с предикатом, выдача строк
+    void sqlQuery(benchmark::State& state, const std::string& sql) {
+        const QueryExecutor executor;
+        TableManager tables;
+        const auto table = BenchData::table(tables, "orders", state.range(0), 1000);
+        const SqlEngine engine(executor, tables);
+        size_t rows = 0;
+        for (auto _ : state) {
+            StatementResult result = engine.execute(sql);
+            Row row;
+            while (result.rows->next(row)) ++rows;
+        }
+        state.SetItemsProcessed(state.iterations() * table->rowCount());
+        state.counters["rows_out"] = benchmark::Counter(static_cast<double>(rows), benchmark::Counter::kAvgIterations);
+    }
+
+    void BM_SqlScanFilter(benchmark::State& state) {
+        sqlQuery(state, "SELECT id, amount FROM orders WHERE key < 10 AND amount > 500");
+    }
+
+    void BM_SqlTopN(benchmark::State& state) {
+        sqlQuery(state, "SELECT id, amount FROM orders ORDER BY amount DESC LIMIT 10");
+    }
+}
+
+BENCHMARK(BM_HashJoinRadix)->RangeMultiplier(4)->Range(1 << 14, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_HashJoinSimple)->RangeMultiplier(4)->Range(1 << 14, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_HashAggregate)
+    ->Args({1 << 20, 16})
+    ->Args({1 << 20, 1 << 16})
+    ->Args({1 << 20, 1 << 20})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SortInMemory)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SqlScanFilter)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SqlTopN)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,53 @@
+#include "query_engine/ast_builder.h"
+#include "query_engine/lexer.h"
+#include <benchmark/benchmark.h>
+#include <string>
+
+namespace {
+    const std::string kPointQuery = "SELECT id, name FROM customers WHERE id = 42";
+    const std::string kRangeQuery =
+        "SELECT id, key, amount, name FROM orders WHERE amount >= 100.5 AND amount < 900 AND key <> 7 "
+        "AND name IS NOT NULL ORDER BY amount DESC, id LIMIT 100 OFFSET 20";
+
+    // INSERT на rows строк: разбор больших пачек вставки
+    std::string insertQuery(size_t rows) {
+        std::string sql = "INSERT INTO orders VALUES ";
+        for (size_t i = 0; i < rows; ++i) {
+            if (i != 0) sql += ", ";
+            sql += "(" + std::to_string(i) + ", " + std::to_string(i % 97) + ", " + std::to_string(i * 1.5) +
+                   ", 'customer#" + std::to_string(i) + "')";
+        }
+        return sql;
+    }
+
+    void lex(benchmark::State& state, const std::string& sql) {
+        for (auto _ : state) benchmark::DoNotOptimize(Lexer(sql).tokenize());
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * sql.size()));
+    }
+
+    void build(benchmark::State& state, const std::string& sql) {
+        for (auto _ : state) benchmark::DoNotOptimize(AstBuilder::build(sql));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * sql.size()));
+    }
+
+    void BM_LexPoint(benchmark::State& state) { lex(state, kPointQuery); }
+    void BM_LexRange(benchmark::State& state) { lex(state, kRangeQuery); }
+    void BM_LexInsert(benchmark::State& state) { lex(state, insertQuery(state.range(0))); }
+
+    void BM_ParsePoint(benchmark::State& state) { build(state, kPointQuery); }
+    void BM_ParseRange(benchmark::State& state) { build(state, kRangeQuery); }
+    void BM_ParseInsert(benchmark::State& state) { build(state, insertQuery(state.range(0))); }
+
+    void BM_NormalizeRange(benchmark::State& state) {
+        for (auto _ : state) benchmark::DoNotOptimize(normalizeQuery(kRangeQuery));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kRangeQuery.size()));
+    }
+}
+
+BENCHMARK(BM_LexPoint);
+BENCHMARK(BM_LexRange);
+BENCHMARK(BM_LexInsert)->Arg(10)->Arg(1000);
+BENCHMARK(BM_ParsePoint);
+BENCHMARK(BM_ParseRange);
+BENCHMARK(BM_ParseInsert)->Arg(10)->Arg(1000);
+BENCHMARK(BM_NormalizeRange);
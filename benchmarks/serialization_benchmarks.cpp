@@ -0,0 +1,73 @@
+#include "api/compression.h"
+#include "api/json_handler.h"
+#include "api/result_encoder.h"
+#include "bench_data.h"
+#include <benchmark/benchmark.h>
+
+namespace {
+    const std::vector<ColumnType> kTypes = {ColumnType::Int64, ColumnType::Int64, ColumnType::Double,
+                                            ColumnType::String};
+
+    // Кодирование результата SELECT; accept выбирает формат, как заголовок Accept
+    void encode(benchmark::State& state, const std::string& accept) {
+        const ResultSet input = BenchData::rows(state.range(0), 1000);
+        std::string out;
+        for (auto _ : state) {
+            auto encoder = makeResultEncoder(accept, input.columns, kTypes);
+            out.clear();
+            encoder->begin(out);
+            for (const Row& row : input.rows) encoder->add(out, row);
+            encoder->finish(out);
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetItemsProcessed(state.iterations() * input.rows.size());
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * out.size()));
+    }
+
+    void BM_EncodeJson(benchmark::State& state) { encode(state, "application/json"); }
+    void BM_EncodeColumnar(benchmark::State& state) { encode(state, kColumnarContentType); }
+
+    // Строка JSON без кодировщика: цена JsonWriter на значение
+    void BM_JsonAppendRow(benchmark::State& state) {
+        const ResultSet input = BenchData::rows(1024, 1000);
+        std::string out;
+        for (auto _ : state) {
+            out.clear();
+            for (const Row& row : input.rows) JsonHandler::appendRow(out, row);
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetItemsProcessed(state.iterations() * input.rows.size());
+    }
+
+    // Сжатие ответа JSON по 64 KB, как chunk'и потоковой выдачи
+    void compress(benchmark::State& state, ContentEncoding encoding) {
+        const ResultSet input = BenchData::rows(1 << 14, 1000);
+        std::string body;
+        for (const Row& row : input.rows) JsonHandler::appendRow(body, row);
+        constexpr size_t kChunk = 64 * 1024;
+        std::string out;
+        for (auto _ : state) {
+            auto compressor = makeCompressor(encoding, static_cast<int>(state.range(0)));
+            if (!compressor) {
+                state.SkipWithError("codec is not built in");
+                break;
+            }
+            out.clear();
+            for (size_t pos = 0; pos < body.size(); pos += kChunk) {
+                compressor->write(std::string_view(body).substr(pos, kChunk), out);
+            }
+            compressor->finish(out);
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * body.size()));
+        state.counters["ratio"] = out.empty() ? 0.0 : static_cast<double>(body.size()) / out.size();
+    }
+
+    void BM_CompressGzip(benchmark::State& state) { compress(state, ContentEncoding::Gzip); }
+    void BM_CompressZstd(benchmark::State& state) { compress(state, ContentEncoding::Zstd); }
+}
+
+BENCHMARK(BM_EncodeJson)->Arg(1 << 16)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EncodeColumnar)->Arg(1 << 16)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_JsonAppendRow)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CompressGzip)->Arg(1)->Arg(6)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CompressZstd)->Arg(1)->Arg(3)->Unit(benchmark::kMillisecond);
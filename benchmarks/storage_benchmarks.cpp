@@ -0,0 +1,70 @@
+#include "bench_data.h"
+#include "common/async_log.h"
+#include "common/metrics.h"
+#include "storage_engine/table_manager.h"
+#include <benchmark/benchmark.h>
+
+namespace {
+    void BM_ColumnAppend(benchmark::State& state) {
+        const ResultSet input = BenchData::rows(1 << 16, 1000);
+        for (auto _ : state) {
+            ColumnarTable table("orders", BenchData::schema());
+            for (const Row& row : input.rows) table.appendRow(row);
+            benchmark::DoNotOptimize(table.rowCount());
+        }
+        state.SetItemsProcessed(state.iterations() * input.rows.size());
+    }
+
+    void BM_ColumnGet(benchmark::State& state) {
+        TableManager tables;
+        const auto table = BenchData::table(tables, "orders", 1 << 16, 1000);
+        const Column& name = table->column(3);
+        for (auto _ : state) {
+            for (size_t i = 0; i < name.size(); ++i) benchmark::DoNotOptimize(name.get(i));
+        }
+        state.SetItemsProcessed(state.iterations() * name.size());
+    }
+
+    // Блокировки таблицы: без конкуренции — цена try_lock, в потоках — с ожиданием
+    // и записью в db_table_lock_wait_seconds
+    ColumnarTable& lockTable() {
+        static ColumnarTable table("locks", BenchData::schema());
+        return table;
+    }
+
+    void BM_TableLockShared(benchmark::State& state) {
+        const ColumnarTable& table = lockTable();
+        for (auto _ : state) {
+            auto lock = table.lockShared();
+            benchmark::DoNotOptimize(lock.owns_lock());
+        }
+    }
+
+    void BM_TableLockExclusive(benchmark::State& state) {
+        ColumnarTable& table = lockTable();
+        for (auto _ : state) {
+            auto lock = table.lockExclusive();
+            benchmark::DoNotOptimize(lock.owns_lock());
+        }
+    }
+
+    // Запись в шардированную гистограмму — горячий путь всех метрик задержки
+    void BM_HistogramRecord(benchmark::State& state) {
+        static Metrics::Histogram histogram;
+        uint64_t micros = state.thread_index();
+        for (auto _ : state) histogram.recordMicros(micros++ & 0xffff);
+    }
+
+    void BM_AsyncLogWrite(benchmark::State& state) {
+        static AsyncLog log("/dev/null", 1 << 16);
+        const std::string entry(200, 'x');
+        for (auto _ : state) benchmark::DoNotOptimize(log.write(entry));
+    }
+}
+
+BENCHMARK(BM_ColumnAppend)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ColumnGet)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TableLockShared)->ThreadRange(1, 8);
+BENCHMARK(BM_TableLockExclusive)->ThreadRange(1, 8);
+BENCHMARK(BM_HistogramRecord)->ThreadRange(1, 8);
+BENCHMARK(BM_AsyncLogWrite)->ThreadRange(1, 4);
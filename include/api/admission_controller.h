@@ -0,0 +1,91 @@
+#pragma once
+#include "api/execution_pool.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Класс нагрузки со своей полосой: сколько запросов исполняется одновременно,
+// сколько ждёт и как долго. Тяжёлые отчёты в своём классе не занимают
+// потоки, зарезервированные за короткими запросами.
+struct WorkloadClass {
+    std::string name;
+    size_t max_concurrent = 4;
+    size_t max_queued = 64;                       // сверх — сразу отказ
+    std::chrono::milliseconds queue_timeout{1000}; // дольше в очереди — отказ
+};
+
+// "oltp" (по умолчанию) и "analytics"
+std::vector<WorkloadClass> defaultWorkloadClasses();
+
+// Допуск запросов к ExecutionPool по классам нагрузки. Запрос сверх лимита
+// класса ждёт в его очереди; полная очередь или истёкшее ожидание — отказ.
+// Очереди с истёкшим сроком разбирает отдельный поток, не дожидаясь,
+// пока освободится слот.
+class AdmissionController {
+public:
+    using Task = std::function<void()>;
+    // Вызывается вместо задачи, с причиной отказа
+    using Reject = std::function<void(const std::string& reason)>;
+
+    // Первый класс — класс по умолчанию. Пул запоминается по ссылке и
+    // используется только в submit и при завершении задач.
+    AdmissionController(std::vector<WorkloadClass> classes, ExecutionPool& pool);
+    ~AdmissionController();
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    // Пустое имя — класс по умолчанию; nullopt — класса нет
+    std::optional<size_t> classIndex(const std::string& name) const;
+    const std::vector<WorkloadClass>& classes() const { return classes_; }
+    // Сумма лимитов: столько потоков исполнения нужно, чтобы классы не ждали друг друга
+    size_t totalConcurrency() const;
+
+    // Ровно одно из task и reject будет вызвано — сразу или позже, на другом потоке
+    void submit(size_t workload_class, Task task, Reject reject);
+
+    // Отклоняет всё ждущее в очередях и все следующие submit. Повторный вызов
+    // ничего не делает; деструктор вызывает сам
+    void shutdown();
+
+    struct LaneStats {
+        size_t running = 0;
+        size_t queued = 0;
+    };
+    // Загрузка полос, в порядке classes()
+    std::vector<LaneStats> stats() const;
+
+private:
+    struct Pending {
+        Task task;
+        Reject reject;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    struct Lane {
+        size_t running = 0;
+        std::deque<Pending> queue;
+    };
+
+    // false — пул не принял задачу
+    bool dispatch(size_t workload_class, Task task);
+    // Слот класса освободился: отдаёт его следующему в очереди
+    void release(size_t workload_class);
+    void expireLoop();
+
+    const std::vector<WorkloadClass> classes_;
+    ExecutionPool& pool_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::vector<Lane> lanes_;
+    bool stopping_ = false;
+    std::thread expirer_;
+};
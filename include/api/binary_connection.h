@@ -0,0 +1,52 @@
+#pragma once
+#include "api/binary_protocol.h"
+#include "api/admission_controller.h"
+#include "query_engine/sql_engine.h"
+#include <asio.hpp>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Соединение бинарного протокола (см. binary_protocol.h). Читает всё, что
+// пришло, исполняет каждый целый кадр по порядку и отправляет ответы одной
+// записью — конвейер из мелких запросов стоит один системный вызов на пачку.
+// Подготовленные операторы живут, пока живо соединение. Кадры исполняются
+// в пуле исполнения по классу нагрузки по умолчанию; при отказе в допуске
+// каждый кадр пачки получает Error Rejected. Клиент, который дольше
+// write_timeout не читает ответ, теряет соединение, а его запрос отменяется.
+class BinaryConnection : public std::enable_shared_from_this<BinaryConnection> {
+public:
+    BinaryConnection(asio::ip::tcp::socket socket, const SqlEngine& engine, const QueryExecutor& executor,
+                     AdmissionController& admission, std::chrono::seconds write_timeout = std::chrono::seconds(0))
+        : socket_(std::move(socket)), engine_(engine), executor_(executor), admission_(admission),
+          write_timeout_(write_timeout) {}
+
+    void start() { read(); }
+
+private:
+    void read();
+    // Исполняет прочитанное и читает дальше; вызывается в пуле исполнения
+    void process(bool rejected);
+    // false — ошибка протокола, соединение надо закрыть
+    bool processFrames(bool rejected);
+    void handleFrame(BinaryProtocol::MessageType type, uint32_t request_id, BinaryProtocol::Reader& reader);
+    void runStatement(uint32_t request_id, const PreparedStatement& statement, const std::vector<Value>& parameters);
+    void writeError(uint32_t request_id, BinaryProtocol::ErrorCode code, std::string_view message);
+    void flush();
+    void close();
+
+    asio::ip::tcp::socket socket_;
+    const SqlEngine& engine_;
+    const QueryExecutor& executor_;
+    AdmissionController& admission_;
+    const std::chrono::seconds write_timeout_;
+
+    std::array<char, 64 * 1024> read_buffer_;
+    std::string in_;
+    std::string out_;
+    std::unordered_map<uint32_t, std::shared_ptr<const PreparedStatement>> statements_;
+    uint32_t next_handle_ = 1;
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include "query_engine/value.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Бинарный протокол. Все числа little-endian.
+//
+// Кадр: u32 length (байт после этого поля), u8 type, u32 request_id, payload.
+// Клиент может слать запросы, не дожидаясь ответов: сервер отвечает строго
+// по порядку, каждый кадр ответа несёт request_id своего запроса.
+//
+// Клиент -> сервер:
+//   Query           SQL-текст (до конца кадра)
+//   Prepare         SQL-текст с параметрами ?           -> Prepared
+//   Execute         u32 handle, u16 n, n значений
+//   CloseStatement  u32 handle                          -> Complete
+// Сервер -> клиент:
+//   RowDescription  u16 n, на колонку: u8 type (0 int64, 1 double, 2 utf8), u16 длина, имя
+//   DataRows        u32 n, n строк, в строке — значения всех колонок
+//   Complete        u64 rows (выдано или изменено), u16 длина, сообщение
+//   Prepared        u32 handle, u16 число параметров
+//   Error           u16 ErrorCode, u16 длина, сообщение
+// SELECT отвечает RowDescription, DataRows*, Complete; остальное — Complete или Error.
+//
+// Значение: u8 tag (0 NULL, 1 int64, 2 double, 3 string), затем 8 байт числа
+// или u32 длина и байты строки.
+namespace BinaryProtocol {
+    enum class MessageType : uint8_t {
+        Query = 0x01,
+        Prepare = 0x02,
+        Execute = 0x03,
+        CloseStatement = 0x04,
+        RowDescription = 0x81,
+        DataRows = 0x82,
+        Complete = 0x83,
+        Prepared = 0x84,
+        Error = 0x85,
+    };
+
+    enum class ErrorCode : uint16_t { Syntax = 1, Query = 2, Rejected = 3, Protocol = 4, Internal = 5, Cancelled = 6 };
+
+    constexpr size_t kLengthBytes = 4;
+    constexpr size_t kMaxFrameBytes = 16 << 20;
+
+    // Кадр не разбирается: соединение закрывается
+    class ProtocolError : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    // Дописывает кадры в буфер исходящих данных
+    class Writer {
+    public:
+        explicit Writer(std::string& out) : out_(out) {}
+
+        // Длина кадра проставляется в endFrame
+        void beginFrame(MessageType type, uint32_t request_id);
+        void endFrame();
+
+        void u8(uint8_t v) { out_ += static_cast<char>(v); }
+        void u16(uint16_t v);
+        void u32(uint32_t v);
+        void u64(uint64_t v);
+        // u16 длина + байты; длиннее 64K обрезается
+        void shortString(std::string_view s);
+        void value(const Value& v);
+
+    private:
+        std::string& out_;
+        size_t frame_start_ = 0;
+    };
+
+    // Читает payload одного кадра; выход за границу — ProtocolError
+    class Reader {
+    public:
+        explicit Reader(std::string_view payload) : data_(payload) {}
+
+        uint8_t u8();
+        uint16_t u16();
+        uint32_t u32();
+        uint64_t u64();
+        Value value();
+        std::string_view rest();
+        bool empty() const { return pos_ == data_.size(); }
+
+    private:
+        std::string_view take(size_t n);
+
+        std::string_view data_;
+        size_t pos_ = 0;
+    };
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+
+enum class ContentEncoding { Identity, Gzip, Zstd };
+
+// Значение для заголовка Content-Encoding
+const char* encodingName(ContentEncoding encoding);
+
+// Лучшая из поддерживаемых кодировок по Accept-Encoding с учётом q; при равном
+// q zstd предпочтительнее gzip. zstd есть, только если сервер собран с libzstd.
+ContentEncoding negotiateEncoding(const std::string& accept_encoding);
+
+// Потоковое сжатие тела ответа. Каждый write() заканчивается сбросом
+// компрессора: кусок chunked-ответа распаковывается клиентом сразу,
+// не дожидаясь следующего.
+class StreamCompressor {
+public:
+    virtual ~StreamCompressor() = default;
+
+    virtual void write(std::string_view data, std::string& out) = 0;
+    // Остаток и хвост формата; после него write() не вызывается
+    virtual void finish(std::string& out) = 0;
+};
+
+// level 0 — уровень кодека по умолчанию; больше максимума — максимум.
+// Для Identity — nullptr.
+std::unique_ptr<StreamCompressor> makeCompressor(ContentEncoding encoding, int level);
@@ -0,0 +1,59 @@
+#pragma once
+#include "query_engine/query_context.h"
+#include "query_engine/sql_engine.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Серверный курсор: результат SELECT, из которого строки забираются
+// порциями. Между выборками исполнитель стоит — дерево RowSource просто
+// никто не тянет, поэтому следующая страница не пересчитывает предыдущие.
+// Сканы берут блокировку таблицы только на сборку пачки и читают снимок на
+// момент открытия: стоящий курсор не задерживает вставки, а новые строки
+// в его страницы не попадают.
+struct Cursor {
+    Cursor(StatementResult result, std::shared_ptr<QueryContext> ctx)
+        : result(std::move(result)), ctx(std::move(ctx)) {}
+
+    StatementResult result;
+    std::shared_ptr<QueryContext> ctx;
+
+    // Одна выборка за раз; поля ниже — под ним
+    std::mutex mutex;
+    // Строка, прочитанная вперёд, чтобы знать, последняя ли это страница
+    Row pending;
+    bool has_pending = false;
+};
+
+// Открытые курсоры по id запроса. Курсор держит память запроса и файлы
+// спилла, поэтому брошенные закрываются по простою.
+class CursorManager {
+public:
+    CursorManager(size_t max_open, std::chrono::seconds idle_timeout)
+        : max_open_(max_open), idle_timeout_(idle_timeout) {}
+
+    // false — открыто уже max_open курсоров
+    bool open(std::shared_ptr<Cursor> cursor);
+    // nullptr — нет такого; иначе простой отсчитывается заново
+    std::shared_ptr<Cursor> find(const std::string& id);
+    bool close(const std::string& id);
+    // Закрывает курсоры, простоявшие дольше idle_timeout; занятые выборкой не трогает
+    void closeIdle();
+
+    std::chrono::seconds idleTimeout() const { return idle_timeout_; }
+    size_t size() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<Cursor> cursor;
+        std::chrono::steady_clock::time_point last_used;
+    };
+
+    size_t max_open_;
+    std::chrono::seconds idle_timeout_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> cursors_;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Потоки исполнения запросов с ограниченной очередью. Сетевые потоки только
+// читают и разбирают запросы и ставят их сюда, поэтому долгий аналитический
+// запрос не задерживает приём и чтение остальных. Задача, не поместившаяся
+// в очередь, сразу получает отказ.
+class ExecutionPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads 0 — по числу аппаратных потоков
+    ExecutionPool(size_t threads, size_t queue_capacity);
+    ~ExecutionPool();
+
+    ExecutionPool(const ExecutionPool&) = delete;
+    ExecutionPool& operator=(const ExecutionPool&) = delete;
+
+    // false — очередь полна или пул остановлен; задача не принята
+    bool trySubmit(Task task);
+
+    // Дорабатывает очередь и останавливает потоки
+    void shutdown();
+
+    size_t threadCount() const { return workers_.size(); }
+    size_t queueCapacity() const { return capacity_; }
+    size_t queued() const;
+
+private:
+    void work();
+
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<Task> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,139 @@
+#pragma once
+#include <asio.hpp>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct HttpRequest {
+    std::string method;
+    std::string target; // как пришёл, вместе с query string
+    std::string path;
+    std::string version;
+    std::unordered_map<std::string, std::string> headers; // имена в нижнем регистре
+    std::string body;
+
+    // Пустая строка, если заголовка нет
+    const std::string& header(const std::string& name) const;
+    // Параметр query string, без percent-декодирования; пустая строка, если его нет
+    std::string queryParam(std::string_view name) const;
+    bool keepAlive() const;
+};
+
+// Ответ пишется прямо в сокет: целиком через send() или потоком
+// через beginChunked()/writeChunk()/endChunked() (Transfer-Encoding: chunked).
+// Запись синхронная; разрыв соединения — исключение asio::system_error.
+// Клиент, не принимающий данные дольше write_timeout, получает обрыв:
+// запись бросает asio::error::timed_out, и запрос разматывается. 0 — без срока.
+class HttpResponseWriter {
+public:
+    HttpResponseWriter(asio::ip::tcp::socket& socket, bool keep_alive,
+                       std::chrono::seconds write_timeout = std::chrono::seconds(0))
+        : socket_(socket), keep_alive_(keep_alive), write_timeout_(write_timeout) {}
+
+    // До начала ответа
+    void setHeader(std::string name, std::string value);
+
+    void send(int status, std::string_view content_type, std::string_view body);
+
+    void beginChunked(int status, std::string_view content_type);
+    void writeChunk(std::string_view data);
+    void endChunked();
+
+    bool headersSent() const { return headers_sent_; }
+    // Статус отправленного ответа; 0 — ещё не отправлен
+    int status() const { return status_; }
+    // Ответ отправлен полностью, соединение можно использовать дальше
+    bool complete() const { return complete_; }
+    bool keepAlive() const { return keep_alive_; }
+
+private:
+    std::string head(int status, std::string_view content_type) const;
+    void write(const std::vector<asio::const_buffer>& buffers);
+
+    asio::ip::tcp::socket& socket_;
+    bool keep_alive_;
+    std::chrono::seconds write_timeout_;
+    std::vector<std::pair<std::string, std::string>> extra_headers_;
+    bool headers_sent_ = false;
+    bool complete_ = false;
+    int status_ = 0;
+};
+
+class HttpConnection;
+
+// Запрос и ответ на него. Обработчик может передать обмен в другой поток и
+// отвечать оттуда: соединение читает следующий запрос, когда уничтожена
+// последняя ссылка на обмен. Без ответа к этому моменту клиент получит 500.
+class HttpExchange {
+public:
+    // Статус ответа и время от разбора запроса до конца ответа
+    using CompletionHook = std::function<void(int status, std::chrono::steady_clock::duration elapsed)>;
+
+    HttpExchange(std::shared_ptr<HttpConnection> connection, HttpRequest request, bool keep_alive);
+    ~HttpExchange();
+
+    HttpExchange(const HttpExchange&) = delete;
+    HttpExchange& operator=(const HttpExchange&) = delete;
+
+    const HttpRequest& request() const { return request_; }
+    HttpResponseWriter& response() { return response_; }
+
+    // Вызывается из деструктора, на том потоке, где отпущена последняя ссылка
+    void onComplete(CompletionHook hook) { on_complete_ = std::move(hook); }
+
+private:
+    std::shared_ptr<HttpConnection> connection_;
+    HttpRequest request_;
+    HttpResponseWriter response_;
+    std::chrono::steady_clock::time_point started_ = std::chrono::steady_clock::now();
+    CompletionHook on_complete_;
+};
+
+// Одно клиентское соединение HTTP/1.1 с keep-alive. Обработчик вызывается
+// на потоке io_context; следующий запрос читается, когда ответ завершён.
+// Сокет должен быть привязан к strand: таймер простоя работает параллельно с чтением.
+class HttpConnection : public std::enable_shared_from_this<HttpConnection> {
+public:
+    using Handler = std::function<void(std::shared_ptr<HttpExchange>)>;
+
+    struct Options {
+        size_t max_body_bytes = size_t{16} << 20;
+        bool keep_alive = true;
+        // Сколько ждать следующего запроса целиком; 0 — без ограничения
+        std::chrono::seconds idle_timeout{60};
+        // Сколько клиент может не принимать ответ; 0 — без ограничения
+        std::chrono::seconds write_timeout{30};
+    };
+
+    HttpConnection(asio::ip::tcp::socket socket, std::shared_ptr<const Handler> handler, Options options);
+
+    void start() { readHeaders(); }
+
+private:
+    friend class HttpExchange;
+
+    void readHeaders();
+    void onHeaders(size_t header_bytes);
+    void dispatch(HttpRequest request);
+    // Ответ на ошибку протокола, после которого соединение закрывается
+    void reject(int status, std::string_view message);
+    void close();
+
+    void armIdleTimer();
+
+    asio::ip::tcp::socket socket_;
+    std::shared_ptr<const Handler> handler_;
+    Options options_;
+    asio::streambuf buffer_;
+    asio::steady_timer idle_timer_;
+    // Запрос у обработчика: таймер простоя, сработавший до отмены, не закрывает сокет
+    bool in_request_ = false;
+};
+
+const char* httpStatusText(int status);
@@ -1,9 +1,102 @@
 #pragma once
+#include "api/admission_controller.h"
+#include "api/compression.h"
+#include "api/cursor_manager.h"
+#include "api/execution_pool.h"
+#include "api/slow_query_log.h"
+#include "query_engine/executor.h"
+#include "query_engine/sql_engine.h"
+#include "storage_engine/table_manager.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct HttpRequest;
+class HttpExchange;
+class HttpResponseWriter;
+class ResultEncoder;
+
+struct ServerConfig {
+    unsigned short port = 8080;
+    unsigned short binary_port = 0;             // бинарный протокол (binary_protocol.h); 0 — выключен
+    size_t io_threads = 0;                      // потоки io_context; 0 — по числу аппаратных потоков
+    size_t worker_threads = 0;                  // потоки параллельных операторов; 0 — по числу аппаратных
+    size_t execution_threads = 0;               // потоки исполнения запросов; 0 — сумма лимитов классов
+    size_t execution_queue_size = 256;          // допущенных запросов в очереди на поток; сверх — 503
+    // Класс выбирается заголовком X-Workload-Class; без него — первый
+    std::vector<WorkloadClass> workload_classes = defaultWorkloadClasses();
+    size_t cursor_fetch_rows = 1000;            // страница курсора без ?rows=
+    size_t max_cursor_fetch_rows = 100000;
+    size_t max_open_cursors = 1024;
+    unsigned cursor_idle_timeout_seconds = 60;  // брошенный курсор держит память запроса
+    bool compression = true;                    // gzip/zstd по Accept-Encoding
+    int compression_level = 0;                  // 0 — уровень кодека по умолчанию
+    size_t min_compress_bytes = 1024;           // ответы меньше уходят несжатыми
+    std::string slow_query_log;                 // файл журнала медленных запросов; пустой — выключен
+    unsigned slow_query_threshold_ms = 1000;
+    size_t max_body_bytes = size_t{16} << 20;   // больше — 413
+    bool keep_alive = true;
+    unsigned keep_alive_timeout_seconds = 60;   // простой соединения между запросами
+    unsigned write_timeout_seconds = 30;        // клиент не принимает ответ дольше — запрос отменяется
+    ExecutorConfig executor;                    // num_threads берётся из worker_threads
+};
 
 class HttpServer {
 public:
-    HttpServer();
+    explicit HttpServer(ServerConfig config = {});
     ~HttpServer();
 
+    // Блокирует до SIGINT/SIGTERM
     void run();
-};
\ No newline at end of file
+
+    const ServerConfig& config() const { return config_; }
+
+private:
+    static ExecutorConfig executorConfig(const ServerConfig& config);
+    size_t executionThreads() const;
+
+    // На сетевом потоке: лёгкие маршруты отвечают сразу, запросы уходят в пул исполнения
+    void handleRequest(std::shared_ptr<HttpExchange> exchange);
+    using Handler = void (HttpServer::*)(const HttpRequest&, HttpResponseWriter&);
+    // Ставит обработчик в пул исполнения через допуск по классу нагрузки
+    void submit(std::shared_ptr<HttpExchange> exchange, Handler handler);
+    // GET /metrics: реестр метрик и gauge'и состояния сервера
+    std::string renderMetrics() const;
+
+    // SQL из тела и контекст запроса, с профилем, если журнал медленных запросов
+    // включён; при ошибке отвечает сам и возвращает nullptr
+    std::shared_ptr<QueryContext> startQuery(const HttpRequest& req, HttpResponseWriter& res, std::string& sql);
+    // X-Statement-Timeout-Ms, 0 — нет заголовка; false — ответ 400 уже отправлен
+    static bool statementTimeout(const HttpRequest& req, HttpResponseWriter& res, std::chrono::milliseconds& timeout);
+
+    void handleQuery(const HttpRequest& req, HttpResponseWriter& res);
+    // POST /api/cursor: исполняет запрос и отдаёт id курсора
+    void handleOpenCursor(const HttpRequest& req, HttpResponseWriter& res);
+    // GET /api/cursor/<id>?rows=N: следующая страница, X-Cursor-Done на последней
+    void handleFetchCursor(const HttpRequest& req, HttpResponseWriter& res);
+    // Кодировка ответа по Accept-Encoding, если сжатие включено
+    ContentEncoding responseEncoding(const HttpRequest& req) const;
+    // Строки уходят chunk'ами по мере того, как их отдаёт исполнитель; каждый chunk
+    // сжимается отдельным сбросом компрессора. Возвращает число строк.
+    uint64_t streamRows(StatementResult& result, ResultEncoder& encoder, HttpResponseWriter& res,
+                        ContentEncoding encoding, QueryProfile* profile);
+    // Целое тело; сжимается, если не меньше min_compress_bytes
+    void sendBody(HttpResponseWriter& res, std::string_view content_type, const std::string& body,
+                  ContentEncoding encoding);
+    // В журнал медленных запросов, если он включён и запрос дошёл до исполнения
+    void logSlowQuery(const std::string& sql, const QueryContext* ctx, uint64_t rows, const std::string& error);
+
+    ServerConfig config_;
+    QueryExecutor executor_;
+    TableManager tables_;
+    SqlEngine engine_{executor_, tables_};
+    CursorManager cursors_;
+    std::unique_ptr<SlowQueryLog> slow_log_;
+    // Пул разрушается первым: дорабатывая очередь, задачи ещё освобождают слоты admission_
+    AdmissionController admission_;
+    ExecutionPool execution_;
+};
@@ -1,7 +1,27 @@
 #pragma once
+#include "query_engine/memory_tracker.h"
+#include "query_engine/value.h"
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace JsonHandler {
+    // {"query": "..."} -> текст запроса; nullopt, если тело не такое
+    std::optional<std::string> parseQueryRequest(const std::string& body);
+
     std::string serializeSuccess(const std::string& message);
     std::string serializeError(const std::string& error_message);
+    std::string serializeStatementResult(const std::string& message, size_t affected_rows);
+
+    // Результат SELECT пишется потоком: заголовок с колонками, строки через запятую, хвост.
+    // Вместе — {"status":"success","data":{"columns":[...],"rows":[[...],...]}}.
+    // Строки дописываются в буфер chunk'а через JsonWriter, без nlohmann::json.
+    std::string serializeResultHeader(const std::vector<std::string>& columns);
+    void appendRow(std::string& out, const Row& row);
+    std::string serializeResultFooter();
+
+    // {"status":"success","data":{"cursor":"...","columns":[...]}}
+    std::string serializeCursor(const std::string& cursor_id, const std::vector<std::string>& columns);
+
+    std::string serializeMemoryUsage(const std::vector<QueryMemoryUsage>& queries, size_t used, size_t limit);
 }
\ No newline at end of file
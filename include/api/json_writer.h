@@ -0,0 +1,26 @@
+#pragma once
+#include "query_engine/value.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Пишет JSON прямо в строку: без промежуточного nlohmann::json и без отступов.
+// Числа — через std::to_chars, строки экранируются за один проход.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    void raw(std::string_view text) { out_ += text; }
+    void null() { out_ += "null"; }
+    // Невалидный UTF-8 заменяется на U+FFFD, как в nlohmann::json::dump с error_handler::replace
+    void string(std::string_view s);
+    void integer(int64_t v);
+    // NaN и бесконечности в JSON непредставимы — пишется null
+    void number(double v);
+    void value(const Value& v);
+    // [v1,v2,...]
+    void row(const Row& row);
+
+private:
+    std::string& out_;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include "query_engine/value.h"
+#include "storage_engine/table_manager.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Формат тела ответа с результатом SELECT. Кодировщик дописывает байты в out;
+// add() может копить строки и выдавать их пачками.
+class ResultEncoder {
+public:
+    virtual ~ResultEncoder() = default;
+
+    virtual const char* contentType() const = 0;
+    virtual void begin(std::string& out) = 0;
+    virtual void add(std::string& out, Row row) = 0;
+    virtual void finish(std::string& out) = 0;
+};
+
+// Колоночный бинарный формат, application/vnd.sirius.columnar. Все числа little-endian.
+//
+//   "SRCB" u16 version=1
+//   u32 column_count, на колонку: u8 type (0 int64, 1 double, 2 utf8), u32 name_len, name
+//   пачки: u32 row_count (0 — конец потока), затем колонки по порядку:
+//     validity: ceil(row_count / 8) байт, бит i = 1 — значение есть (LSB first)
+//     int64/double: row_count * 8 байт (на месте NULL — 0)
+//     utf8: (row_count + 1) u32 смещений, затем байты строк
+//
+// Клиент читает колонку одним куском, без разбора текста.
+constexpr const char* kColumnarContentType = "application/vnd.sirius.columnar";
+
+// Код типа колонки на проводе: общий для колоночного формата и бинарного протокола
+uint8_t columnTypeCode(ColumnType type);
+
+// По заголовку Accept: колоночный формат, если клиент его просит, иначе JSON
+std::unique_ptr<ResultEncoder> makeResultEncoder(const std::string& accept, std::vector<std::string> columns,
+                                                 std::vector<ColumnType> types);
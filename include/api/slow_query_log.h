@@ -0,0 +1,26 @@
+#pragma once
+#include "common/async_log.h"
+#include "query_engine/query_context.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Журнал запросов, которые шли дольше порога: нормализованный текст, время
+// фаз, план с числом строк и временем каждого оператора (вместе с детьми),
+// ожидание блокировок.
+// Профиль собирается, только если контекст создан с enableProfile().
+class SlowQueryLog {
+public:
+    // Бросает std::runtime_error, если файл не открылся
+    SlowQueryLog(const std::string& path, std::chrono::milliseconds threshold);
+
+    std::chrono::milliseconds threshold() const { return threshold_; }
+
+    // По завершении запроса, с любого потока. Длительность — от создания
+    // контекста; error пустой, если запрос выполнен.
+    void record(const std::string& sql, const QueryContext& ctx, uint64_t rows, const std::string& error);
+
+private:
+    std::chrono::milliseconds threshold_;
+    AsyncLog log_;
+};
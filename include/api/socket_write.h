@@ -0,0 +1,16 @@
+#pragma once
+#include <asio.hpp>
+#include <chrono>
+#include <vector>
+
+// Синхронная запись в сокет со сроком, для потоков исполнения запросов.
+// Запись идёт через async_write на io_context сокета, рядом — таймер,
+// который отменяет её по истечении timeout; вызывающий поток ждёт исхода.
+// Клиент, не принимающий данные дольше timeout, получает
+// asio::system_error(asio::error::timed_out). timeout 0 — обычная
+// блокирующая запись без срока.
+//
+// Со сроком io_context должен работать, пока запись не закончится. На
+// потоке, исполняющем io_context, запись блокирующая и без срока.
+void writeWithDeadline(asio::ip::tcp::socket& socket, const std::vector<asio::const_buffer>& buffers,
+                       std::chrono::seconds timeout);
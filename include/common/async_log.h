@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Журнал в файл, который не задерживает пишущих. Записи уходят в кольцевую
+// очередь без блокировок (ограниченная очередь Вьюкова: у ячейки свой номер
+// поколения, производители делят позицию через CAS), файл пишет отдельный
+// поток. Переполненная очередь отбрасывает запись, а не ждёт.
+class AsyncLog {
+public:
+    // capacity округляется вверх до степени двойки.
+    // Бросает std::runtime_error, если файл не открылся на дозапись.
+    explicit AsyncLog(const std::string& path, size_t capacity = 4096);
+    // Дописывает очередь и закрывает файл
+    ~AsyncLog();
+
+    AsyncLog(const AsyncLog&) = delete;
+    AsyncLog& operator=(const AsyncLog&) = delete;
+
+    // С любого потока. Запись пишется как есть, перевод строки — забота вызывающего.
+    // false — очередь полна, запись отброшена.
+    bool write(std::string entry);
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence{0};
+        std::string entry;
+    };
+
+    bool pop(std::string& entry);
+    void writeLoop();
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> stopping_{false};
+    std::FILE* file_;
+    std::thread writer_;
+};
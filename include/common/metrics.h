@@ -0,0 +1,168 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Метрики процесса в формате Prometheus. Запись не берёт блокировок: у каждой
+// метрики по шарду на группу потоков, каждый шард в своей кэш-линии, поток
+// пишет только в свой. Чтение при экспорте суммирует шарды.
+namespace Metrics {
+    constexpr size_t kShards = 16;
+
+    // Шард текущего потока: потоки раздаются по шардам по кругу
+    size_t shardIndex();
+
+    class Counter {
+    public:
+        void inc(uint64_t n = 1) { shards_[shardIndex()].value.fetch_add(n, std::memory_order_relaxed); }
+        uint64_t value() const;
+
+    private:
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> value{0};
+        };
+        std::array<Shard, kShards> shards_;
+    };
+
+    // Длительности в микросекундах. Корзины лог-линейные, как в HdrHistogram:
+    // значения до 8 — точно, дальше каждая октава 2^k..2^(k+1) делится на 8
+    // равных корзин, то есть относительная ошибка не больше 12.5 %.
+    class Histogram {
+    public:
+        static constexpr unsigned kSubBits = 3;
+        static constexpr size_t kSubBuckets = size_t{1} << kSubBits;
+        static constexpr size_t kBuckets = kSubBuckets * 41; // до 2^43 мкс
+
+        Histogram();
+
+        void record(std::chrono::nanoseconds duration) {
+            recordMicros(static_cast<uint64_t>(std::max<int64_t>(0, duration.count() / 1000)));
+        }
+        void recordMicros(uint64_t micros);
+
+        struct Snapshot {
+            std::vector<uint64_t> buckets;
+            uint64_t count = 0;
+            uint64_t sum_micros = 0;
+
+            // Верхняя граница корзины, в которой лежит квантиль q
+            uint64_t quantileMicros(double q) const;
+            // Сколько значений меньше limit; limit — степень двойки, граница корзин
+            uint64_t countBelow(uint64_t limit) const;
+        };
+        Snapshot snapshot() const;
+
+        static size_t bucketIndex(uint64_t micros);
+        // Значения корзины index лежат в [lower, upper)
+        static uint64_t bucketUpper(size_t index);
+
+    private:
+        struct alignas(64) Shard {
+            std::array<std::atomic<uint64_t>, kBuckets> buckets{};
+            std::atomic<uint64_t> count{0};
+            std::atomic<uint64_t> sum{0};
+        };
+        std::unique_ptr<Shard[]> shards_;
+    };
+
+    // Измеряет время жизни и пишет его в гистограмму
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram& histogram)
+            : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() { histogram_.record(std::chrono::steady_clock::now() - start_); }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Histogram& histogram_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    // Метрики одного имени с разными значениями меток. Экземпляр создаётся при
+    // первом обращении и живёт до конца процесса, так что ссылку на него можно
+    // хранить. Поток запоминает найденные экземпляры: блокировка семейства —
+    // только при первом обращении потока к этим меткам.
+    template <typename Metric>
+    class Family {
+    public:
+        Family(std::string name, std::string help, std::vector<std::string> label_names)
+            : name_(std::move(name)), help_(std::move(help)), label_names_(std::move(label_names)) {}
+
+        // Значения меток в порядке label_names
+        Metric& with(std::initializer_list<std::string_view> values) {
+            std::string key;
+            for (std::string_view v : values) {
+                key.append(v);
+                key += '\x1f';
+            }
+            thread_local std::unordered_map<const void*, std::unordered_map<std::string, Metric*>> cache;
+            auto& mine = cache[this];
+            auto it = mine.find(key);
+            if (it != mine.end()) return *it->second;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& slot = metrics_[std::vector<std::string>(values.begin(), values.end())];
+            if (!slot) slot = std::make_unique<Metric>();
+            mine.emplace(std::move(key), slot.get());
+            return *slot;
+        }
+
+        const std::string& name() const { return name_; }
+        const std::string& help() const { return help_; }
+        const std::vector<std::string>& labelNames() const { return label_names_; }
+
+        // Для экспорта: обходит экземпляры под блокировкой семейства
+        template <typename Fn>
+        void forEach(Fn fn) const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& [values, metric] : metrics_) fn(values, *metric);
+        }
+
+    private:
+        std::string name_;
+        std::string help_;
+        std::vector<std::string> label_names_;
+        mutable std::mutex mutex_;
+        std::map<std::vector<std::string>, std::unique_ptr<Metric>> metrics_;
+    };
+
+    class Registry {
+    public:
+        // Повторный вызов с тем же именем возвращает то же семейство
+        Family<Counter>& counter(const std::string& name, const std::string& help,
+                                 std::vector<std::string> label_names = {});
+        Family<Histogram>& histogram(const std::string& name, const std::string& help,
+                                     std::vector<std::string> label_names = {});
+
+        // Все семейства в текстовом формате Prometheus 0.0.4; гистограммы — в секундах
+        void render(std::string& out) const;
+
+    private:
+        mutable std::mutex mutex_;
+        std::map<std::string, std::unique_ptr<Family<Counter>>> counters_;
+        std::map<std::string, std::unique_ptr<Family<Histogram>>> histograms_;
+    };
+
+    // Реестр процесса
+    Registry& registry();
+
+    // Gauge, который владелец считает сам при экспорте: HELP, TYPE и значение
+    void renderGauge(std::string& out, const std::string& name, const std::string& help, double value);
+    // То же для gauge с метками: заголовок один, затем renderSample на каждое значение
+    void renderGaugeHeader(std::string& out, const std::string& name, const std::string& help);
+    void renderSample(std::string& out, const std::string& name, const std::vector<std::string>& label_names,
+                      const std::vector<std::string>& label_values, double value);
+}
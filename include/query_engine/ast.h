@@ -1,6 +1,48 @@
 #pragma once
+#include "query_engine/executor.h"
+#include "storage_engine/table_manager.h"
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 struct ASTNode {
     virtual ~ASTNode() = default;
-};
\ No newline at end of file
+};
+
+// column <op> literal; литерал для IS [NOT] NULL не задаётся.
+// parameter — номер параметра ?, значение которого подставляется при исполнении.
+struct Condition {
+    std::string column;
+    CompareOp op;
+    Value value;
+    std::optional<size_t> parameter;
+};
+
+struct OrderItem {
+    std::string column;
+    bool descending = false;
+};
+
+// SELECT columns FROM table [WHERE c AND ...] [ORDER BY ...] [LIMIT n [OFFSET m]]
+struct SelectStatement : ASTNode {
+    std::vector<std::string> columns; // пусто — SELECT *
+    std::string table;
+    std::vector<Condition> where;
+    std::vector<OrderItem> order_by;
+    std::optional<size_t> limit;
+    size_t offset = 0;
+};
+
+struct CreateTableStatement : ASTNode {
+    std::string table;
+    std::vector<ColumnSpec> columns;
+};
+
+// INSERT INTO table VALUES (...), (...): значения для всех колонок по порядку
+struct InsertStatement : ASTNode {
+    std::string table;
+    std::vector<Row> rows;
+    // (строка, колонка) для каждого параметра ? по порядку номеров
+    std::vector<std::pair<size_t, size_t>> parameters;
+};
@@ -1,2 +1,15 @@
 #pragma once
-class AstBuilder {};
\ No newline at end of file
+#include "query_engine/ast.h"
+#include <memory>
+#include <string_view>
+
+struct ParsedStatement {
+    std::unique_ptr<ASTNode> ast;
+    size_t parameter_count = 0; // параметров ?
+};
+
+// Текст запроса -> AST: Lexer, затем Parser. Ошибки — SyntaxError.
+class AstBuilder {
+public:
+    static ParsedStatement build(std::string_view sql);
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Блочный Bloom-фильтр (split block): каждый ключ трогает один блок в 32 байта,
+// по одному биту в каждом из 8 слов — одна кэш-линия на вставку и проверку.
+class BloomFilter {
+public:
+    explicit BloomFilter(size_t expected_items) { blocks_.assign(blockCount(expected_items), Block{}); }
+
+    // Сколько займут биты фильтра на expected_items ключей — до его создания
+    static size_t bytesFor(size_t expected_items) { return blockCount(expected_items) * sizeof(Block); }
+
+    void insert(uint64_t hash) {
+        Block& block = blocks_[blockIndex(hash)];
+        const uint32_t key = static_cast<uint32_t>(hash);
+        for (int i = 0; i < 8; ++i) block.words[i] |= bitFor(key, i);
+    }
+
+    bool mayContain(uint64_t hash) const {
+        const Block& block = blocks_[blockIndex(hash)];
+        const uint32_t key = static_cast<uint32_t>(hash);
+        for (int i = 0; i < 8; ++i) {
+            if ((block.words[i] & bitFor(key, i)) == 0) return false;
+        }
+        return true;
+    }
+
+    size_t sizeBytes() const { return blocks_.size() * sizeof(Block); }
+
+private:
+    static constexpr size_t kBlockBits = 256;
+
+    struct Block {
+        uint32_t words[8] = {};
+    };
+
+    static size_t blockCount(size_t expected_items) {
+        // ~12 бит на ключ — около 1% ложных срабатываний
+        const size_t blocks = (expected_items * 12 + kBlockBits - 1) / kBlockBits;
+        return blocks == 0 ? 1 : blocks;
+    }
+
+    size_t blockIndex(uint64_t hash) const {
+        return static_cast<size_t>(((hash >> 32) * blocks_.size()) >> 32);
+    }
+
+    static uint32_t bitFor(uint32_t key, int i) {
+        static constexpr uint32_t kSalt[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                              0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+        return uint32_t{1} << ((key * kSalt[i]) >> 27);
+    }
+
+    std::vector<Block> blocks_;
+};
@@ -1,2 +1,137 @@
 #pragma once
-class QueryExecutor {};
\ No newline at end of file
+#include "query_engine/memory_tracker.h"
+#include "query_engine/query_context.h"
+#include "query_engine/value.h"
+#include "storage_engine/file_manager.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct PlanNode;
+
+struct ResultSet {
+    std::vector<std::string> columns;
+    std::vector<Row> rows;
+};
+
+enum class AggregateFunction { Count, Sum, Min, Max, Avg };
+
+// COUNT(*) — агрегат без колонки
+constexpr size_t kStarColumn = static_cast<size_t>(-1);
+
+struct AggregateSpec {
+    AggregateFunction function;
+    size_t column = kStarColumn;
+    std::string name; // пустое — имя генерируется, например "sum(price)"
+};
+
+struct SortKey {
+    size_t column;
+    bool descending = false;
+};
+
+enum class CompareOp { Eq, Ne, Lt, Le, Gt, Ge, IsNull, IsNotNull };
+
+// column <op> value над колонкой таблицы. Сравнение с NULL ложно, как в SQL;
+// value не используется для IsNull и IsNotNull.
+struct ColumnPredicate {
+    size_t column;
+    CompareOp op;
+    Value value;
+};
+
+// Потоковый источник строк: next() возвращает false, когда строки кончились
+class RowSource {
+public:
+    virtual ~RowSource() = default;
+    virtual bool next(Row& row) = 0;
+};
+
+// Отдаёт строки ResultSet, перемещая их — память освобождается по мере чтения
+class ResultSetSource : public RowSource {
+public:
+    explicit ResultSetSource(std::vector<Row> rows) : rows_(std::move(rows)) {}
+
+    bool next(Row& row) override {
+        if (pos_ == rows_.size()) {
+            std::vector<Row>().swap(rows_);
+            pos_ = 0;
+            return false;
+        }
+        row = std::move(rows_[pos_++]);
+        return true;
+    }
+
+private:
+    std::vector<Row> rows_;
+    size_t pos_ = 0;
+};
+
+struct ExecutorConfig {
+    size_t num_threads = 0;                         // 0 — по числу аппаратных потоков
+    size_t query_memory_budget = size_t{256} << 20; // байт на запрос, дальше — спилл на диск
+    size_t global_memory_limit = size_t{4} << 30;   // байт на все запросы процесса
+    std::string temp_dir;                           // пустой — системный temp
+    std::chrono::milliseconds statement_timeout{0}; // 0 — без ограничения
+};
+
+class QueryExecutor {
+public:
+    explicit QueryExecutor(ExecutorConfig config = {});
+
+    // Контекст запроса с учётом памяти в губернаторе; memory_budget и timeout 0 — из конфига.
+    // Срок отсчитывается от создания контекста. Бросает QueryRejected, если
+    // глобальный лимит исчерпан, и std::invalid_argument, если запрос с таким
+    // id уже исполняется. Операторы без контекста создают себе собственный.
+    std::shared_ptr<QueryContext> createContext(const std::string& query_id = "", size_t memory_budget = 0,
+                                                std::chrono::milliseconds timeout = {}) const;
+
+    // Отмена исполняющегося запроса; false — такого нет
+    bool cancel(const std::string& query_id) const { return queries_->cancel(query_id); }
+
+    // Внутреннее equi-соединение left.key = right.key.
+    // Результат: колонки left, затем колонки right. NULL-ключи не совпадают ни с чем.
+    ResultSet hashJoin(const ResultSet& left, size_t left_key,
+                       const ResultSet& right, size_t right_key,
+                       std::shared_ptr<QueryContext> ctx = nullptr) const;
+
+    // Классический hash join на цепочках, без партиционирования.
+    // Используется для маленьких входов и как эталон для бенчмарков.
+    ResultSet simpleHashJoin(const ResultSet& left, size_t left_key,
+                             const ResultSet& right, size_t right_key) const;
+
+    // GROUP BY group_keys с агрегатами. Результат: ключевые колонки, затем агрегаты.
+    // Без ключей — один глобальный ряд, даже на пустом входе.
+    ResultSet hashAggregate(const ResultSet& input, const std::vector<size_t>& group_keys,
+                            const std::vector<AggregateSpec>& aggregates,
+                            std::shared_ptr<QueryContext> ctx = nullptr) const;
+
+    // ORDER BY. Прогоны сортируются в памяти по нормализованным ключам; если вход
+    // не помещается в бюджет запроса, прогоны уходят во временные файлы
+    // и сливаются loser tree. Результат читается потоком.
+    std::unique_ptr<RowSource> sort(std::unique_ptr<RowSource> input, const std::vector<SortKey>& keys,
+                                    std::shared_ptr<QueryContext> ctx = nullptr) const;
+    ResultSet sort(ResultSet input, const std::vector<SortKey>& keys,
+                   std::shared_ptr<QueryContext> ctx = nullptr) const;
+
+    // Исполняет физический план (после QueryOptimizer) и отдаёт строки потоком
+    std::unique_ptr<RowSource> execute(const PlanNode& plan, std::shared_ptr<QueryContext> ctx = nullptr) const;
+    ResultSet executeToResult(const PlanNode& plan, std::shared_ptr<QueryContext> ctx = nullptr) const;
+
+    size_t threadCount() const { return num_threads_; }
+    const ExecutorConfig& config() const { return config_; }
+    const MemoryGovernor& memoryGovernor() const { return *governor_; }
+
+private:
+    std::shared_ptr<QueryContext> contextOrNew(std::shared_ptr<QueryContext> ctx) const;
+
+    ExecutorConfig config_;
+    size_t num_threads_;
+    std::shared_ptr<FileManager> files_;
+    std::shared_ptr<MemoryGovernor> governor_;
+    std::shared_ptr<QueryRegistry> queries_;
+    mutable std::atomic<uint64_t> next_query_id_{1};
+};
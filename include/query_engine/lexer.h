@@ -1,2 +1,48 @@
 #pragma once
-class Lexer {};
\ No newline at end of file
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Ошибка в тексте запроса; position — смещение в исходной строке
+class SyntaxError : public std::runtime_error {
+public:
+    SyntaxError(const std::string& message, size_t position)
+        : std::runtime_error(message + " at position " + std::to_string(position)), position_(position) {}
+
+    size_t position() const { return position_; }
+
+private:
+    size_t position_;
+};
+
+enum class TokenType { Identifier, Keyword, Integer, Float, String, Symbol, End };
+
+struct Token {
+    TokenType type;
+    std::string text; // ключевые слова — в верхнем регистре, строки — без кавычек
+    size_t position;
+};
+
+// Текст запроса с литералами, заменёнными на ?: запросы, которые отличаются
+// только константами, дают одну строку. Комментарии и лишние пробелы убираются.
+// Текст, который не разбирается лексером, возвращается как есть.
+std::string normalizeQuery(std::string_view sql);
+
+class Lexer {
+public:
+    explicit Lexer(std::string_view sql) : sql_(sql) {}
+
+    // Последний токен всегда End
+    std::vector<Token> tokenize();
+
+private:
+    Token next();
+    Token number();
+    Token word();
+    Token quoted(char quote, TokenType type);
+
+    std::string_view sql_;
+    size_t pos_ = 0;
+};
@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class MemoryGovernor;
+
+// Запрос не уложился в бюджет там, где вытеснить на диск нечего
+class MemoryLimitExceeded : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Новый запрос не принят: процесс и так у глобального лимита
+class QueryRejected : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+struct QueryMemoryUsage {
+    std::string query_id;
+    size_t used;
+    size_t peak;
+    size_t limit;
+};
+
+// Учёт памяти одного запроса. Резервирование проходит и по бюджету запроса,
+// и по глобальному лимиту губернатора.
+class QueryMemoryTracker {
+public:
+    QueryMemoryTracker(std::shared_ptr<MemoryGovernor> governor, std::string query_id, size_t limit);
+    ~QueryMemoryTracker();
+
+    QueryMemoryTracker(const QueryMemoryTracker&) = delete;
+    QueryMemoryTracker& operator=(const QueryMemoryTracker&) = delete;
+
+    // false — памяти нет, оператор должен вытеснить данные на диск
+    bool tryReserve(size_t bytes);
+    // Для буферов, которые вытеснить нельзя; бросает MemoryLimitExceeded
+    void reserve(size_t bytes);
+    void release(size_t bytes);
+
+    const std::string& queryId() const { return query_id_; }
+    size_t used() const { return used_; }
+    size_t peak() const { return peak_; }
+    size_t limit() const { return limit_; }
+
+private:
+    std::shared_ptr<MemoryGovernor> governor_;
+    std::string query_id_;
+    size_t limit_;
+    std::atomic<size_t> used_{0};
+    std::atomic<size_t> peak_{0};
+};
+
+// RAII-резерв оператора: всё зарезервированное возвращается в деструкторе
+class MemoryReservation {
+public:
+    explicit MemoryReservation(QueryMemoryTracker& tracker) : tracker_(tracker) {}
+    ~MemoryReservation() { reset(); }
+
+    MemoryReservation(MemoryReservation&& other) noexcept : tracker_(other.tracker_), bytes_(other.bytes_) {
+        other.bytes_ = 0;
+    }
+
+    MemoryReservation(const MemoryReservation&) = delete;
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+    bool tryGrow(size_t bytes) {
+        if (!tracker_.tryReserve(bytes)) return false;
+        bytes_ += bytes;
+        return true;
+    }
+
+    void grow(size_t bytes) {
+        tracker_.reserve(bytes);
+        bytes_ += bytes;
+    }
+
+    // Возвращает часть резерва, например когда строку вытеснила другая
+    void shrink(size_t bytes) {
+        if (bytes > bytes_) bytes = bytes_;
+        tracker_.release(bytes);
+        bytes_ -= bytes;
+    }
+
+    void reset() {
+        tracker_.release(bytes_);
+        bytes_ = 0;
+    }
+
+    // Передаёт часть резерва другому резерву того же запроса: память сменила
+    // владельца, учёт не меняется
+    void transferTo(MemoryReservation& other, size_t bytes) {
+        if (bytes > bytes_) bytes = bytes_;
+        bytes_ -= bytes;
+        other.bytes_ += bytes;
+    }
+
+    size_t bytes() const { return bytes_; }
+
+private:
+    QueryMemoryTracker& tracker_;
+    size_t bytes_ = 0;
+};
+
+// Глобальный лимит памяти исполнителя на все запросы процесса
+class MemoryGovernor : public std::enable_shared_from_this<MemoryGovernor> {
+public:
+    explicit MemoryGovernor(size_t global_limit);
+
+    // Бросает QueryRejected, если свободно меньше минимального резерва запроса
+    std::shared_ptr<QueryMemoryTracker> admit(const std::string& query_id, size_t query_limit);
+
+    size_t used() const { return used_; }
+    size_t limit() const { return limit_; }
+    std::vector<QueryMemoryUsage> snapshot() const;
+
+private:
+    friend class QueryMemoryTracker;
+
+    bool tryReserve(size_t bytes);
+    void release(size_t bytes);
+    void unregister(const QueryMemoryTracker* tracker);
+
+    size_t limit_;
+    std::atomic<size_t> used_{0};
+    mutable std::mutex mutex_;
+    std::vector<const QueryMemoryTracker*> queries_;
+};
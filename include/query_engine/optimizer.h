@@ -1,2 +1,14 @@
 #pragma once
-class QueryOptimizer {};
\ No newline at end of file
+#include "query_engine/plan.h"
+#include <memory>
+
+class QueryOptimizer {
+public:
+    std::unique_ptr<PlanNode> optimize(std::unique_ptr<PlanNode> plan) const;
+
+private:
+    // Limit(Sort(x)) -> TopN(x): куча на limit + offset строк вместо полной сортировки
+    std::unique_ptr<PlanNode> rewriteTopN(std::unique_ptr<PlanNode> node) const;
+    // HashJoin со сканом на probe-стороне: Bloom-фильтр ключей build отсекает строки в скане
+    void markBloomPushdown(PlanNode& node) const;
+};
@@ -1,2 +1,38 @@
 #pragma once
-class Parser {};
\ No newline at end of file
+#include "query_engine/ast.h"
+#include "query_engine/lexer.h"
+#include <memory>
+#include <vector>
+
+// Рекурсивный спуск по токенам Lexer. Ошибки — SyntaxError.
+class Parser {
+public:
+    explicit Parser(std::vector<Token> tokens) : tokens_(std::move(tokens)) {}
+
+    // Один оператор; завершающая ';' допускается
+    std::unique_ptr<ASTNode> parseStatement();
+    // Число параметров ? в разобранном операторе
+    size_t parameterCount() const { return parameter_count_; }
+
+private:
+    std::unique_ptr<SelectStatement> parseSelect();
+    std::unique_ptr<CreateTableStatement> parseCreateTable();
+    std::unique_ptr<InsertStatement> parseInsert();
+
+    Condition parseCondition();
+    Value parseLiteral();
+    ColumnType parseColumnType();
+    size_t parseCount();
+    std::string parseIdentifier();
+
+    const Token& peek() const { return tokens_[pos_]; }
+    bool acceptKeyword(const char* keyword);
+    bool acceptSymbol(const char* symbol);
+    void expectKeyword(const char* keyword);
+    void expectSymbol(const char* symbol);
+    [[noreturn]] void fail(const std::string& expected) const;
+
+    std::vector<Token> tokens_;
+    size_t pos_ = 0;
+    size_t parameter_count_ = 0;
+};
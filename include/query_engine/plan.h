@@ -0,0 +1,44 @@
+#pragma once
+#include "query_engine/executor.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+class ColumnarTable;
+
+constexpr size_t kNoLimit = static_cast<size_t>(-1);
+
+// Физический план: дерево операторов, которое строит оптимизатор и исполняет QueryExecutor
+struct PlanNode {
+    enum class Type { Scan, ColumnarScan, Sort, Limit, TopN, HashJoin };
+
+    Type type;
+    std::vector<std::unique_ptr<PlanNode>> children;
+
+    const ResultSet* input = nullptr;        // Scan
+    const ColumnarTable* table = nullptr;    // ColumnarScan
+    std::vector<size_t> projection;          // ColumnarScan: колонки таблицы на выходе
+    std::vector<ColumnPredicate> predicates; // ColumnarScan: номера колонок — в таблице
+    std::vector<SortKey> sort_keys;          // Sort, TopN
+    size_t limit = kNoLimit;                 // Limit, TopN
+    size_t offset = 0;                       // Limit, TopN
+    bool threshold_pushdown = false;         // TopN: порог кучи проверяется прямо в скане
+    size_t left_key = 0;                     // HashJoin: children[0] — probe, children[1] — build
+    size_t right_key = 0;
+    bool bloom_pushdown = false;             // HashJoin: Bloom-фильтр ключей build проверяется в скане probe
+};
+
+std::unique_ptr<PlanNode> makeScan(const ResultSet& input);
+// Предикаты считаются по своим колонкам; остальные колонки projection
+// читаются только для строк, прошедших все предикаты
+std::unique_ptr<PlanNode> makeColumnarScan(const ColumnarTable& table, std::vector<size_t> projection,
+                                           std::vector<ColumnPredicate> predicates = {});
+std::unique_ptr<PlanNode> makeSort(std::unique_ptr<PlanNode> child, std::vector<SortKey> keys);
+std::unique_ptr<PlanNode> makeLimit(std::unique_ptr<PlanNode> child, size_t limit, size_t offset = 0);
+// Результат: колонки left, затем колонки right; right — build-сторона
+std::unique_ptr<PlanNode> makeHashJoin(std::unique_ptr<PlanNode> left, size_t left_key,
+                                       std::unique_ptr<PlanNode> right, size_t right_key);
+
+std::vector<std::string> planColumns(const PlanNode& node);
+// Верхняя оценка числа строк на выходе узла
+size_t estimateRows(const PlanNode& node);
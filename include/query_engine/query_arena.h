@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Bump-аллокатор для временных данных операторов: выделение — сдвиг указателя
+// в текущем блоке, освобождения по одному нет. reset() отдаёт всё разом и
+// оставляет блоки для следующего заполнения, так что повторные циклы
+// «заполнить — сбросить» не ходят в malloc. Один поток за раз.
+//
+// Память арены учитывают сами операторы в своих MemoryReservation, как и
+// раньше учитывали векторы, на место которых пришла арена.
+class QueryArena {
+public:
+    QueryArena() = default;
+
+    QueryArena(const QueryArena&) = delete;
+    QueryArena& operator=(const QueryArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    // Неинициализированный массив; деструкторы не вызываются
+    template <typename T>
+    T* allocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "QueryArena never runs destructors");
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Копия байтов, живёт до reset()
+    std::string_view copy(std::string_view bytes);
+
+    // Всё выделенное становится недействительным
+    void reset();
+
+    // Байт в блоках — сколько арена держит у malloc
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_;
+    size_t current_ = 0; // заполняемый блок; следующие — свободные после reset()
+    size_t offset_ = 0;
+    size_t capacity_ = 0;
+};
+
+// Арены одного запроса. Оператор или воркер берёт арену в аренду на время
+// своей работы и возвращает сброшенной; блоки переходят к следующему
+// арендатору и освобождаются вместе с запросом. У каждого воркера своя арена,
+// поэтому параллельные операторы не делят ни malloc, ни блокировку.
+class ArenaPool {
+public:
+    class Lease {
+    public:
+        Lease(ArenaPool& pool, std::unique_ptr<QueryArena> arena) : pool_(&pool), arena_(std::move(arena)) {}
+        ~Lease();
+
+        Lease(Lease&& other) noexcept = default;
+        Lease& operator=(Lease&&) = delete;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        QueryArena& operator*() const { return *arena_; }
+        QueryArena* operator->() const { return arena_.get(); }
+
+    private:
+        ArenaPool* pool_;
+        std::unique_ptr<QueryArena> arena_;
+    };
+
+    // Аренда не должна пережить пул
+    Lease acquire();
+
+private:
+    void release(std::unique_ptr<QueryArena> arena);
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<QueryArena>> free_;
+};
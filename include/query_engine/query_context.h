@@ -0,0 +1,160 @@
+#pragma once
+#include "common/metrics.h"
+#include "query_engine/memory_tracker.h"
+#include "query_engine/query_arena.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+class QueryRegistry;
+
+// db_query_phase_seconds{phase}: lex, parse, optimize, execute, serialize.
+// Одна запись на фазу запроса; execute и serialize потокового результата —
+// суммарное время по всем пачкам.
+Metrics::Histogram& queryPhaseHistogram(const char* phase);
+
+// Запрос остановлен: отменён извне или вышел за statement timeout
+class QueryCancelled : public std::runtime_error {
+public:
+    QueryCancelled(const std::string& message, bool timed_out)
+        : std::runtime_error(message), timed_out_(timed_out) {}
+
+    bool timedOut() const { return timed_out_; }
+
+private:
+    bool timed_out_;
+};
+
+// Профиль одного запроса для журнала медленных запросов: фазы, операторы
+// плана, ожидание блокировок таблиц. Операторы пишут в профиль с потока,
+// который тянет строки, — по одному за раз, поэтому без атомиков.
+class QueryProfile {
+public:
+    enum class Phase { Parse, Optimize, Execute, Serialize };
+    static constexpr size_t kPhases = 4;
+
+    struct Operator {
+        std::string name;
+        size_t depth = 0;                       // глубина в дереве плана
+        uint64_t rows = 0;
+        uint64_t calls = 0;
+        // Время — с детьми. Часы читаются на первом вызове next(), где блокирующие
+        // операторы делают всю работу, и дальше на каждом kSampleEvery-м.
+        std::chrono::nanoseconds first_call{0};
+        std::chrono::nanoseconds sampled{0};
+        uint64_t sampled_calls = 0;
+
+        // Оценка полного времени по выборке вызовов
+        std::chrono::nanoseconds elapsed() const;
+    };
+    static constexpr uint64_t kSampleEvery = 16;
+
+    void addPhase(Phase phase, std::chrono::nanoseconds time) { phases_[static_cast<size_t>(phase)] += time; }
+    std::chrono::nanoseconds phase(Phase phase) const { return phases_[static_cast<size_t>(phase)]; }
+
+    // Ссылка живёт, пока жив профиль; операторы добавляются в порядке обхода плана
+    Operator& addOperator(std::string name, size_t depth);
+    const std::deque<Operator>& operators() const { return operators_; }
+
+    void addLockWait(std::chrono::nanoseconds time) { lock_wait_ += time; }
+    std::chrono::nanoseconds lockWait() const { return lock_wait_; }
+
+private:
+    std::chrono::nanoseconds phases_[kPhases] = {};
+    std::deque<Operator> operators_;
+    std::chrono::nanoseconds lock_wait_{0};
+};
+
+// Время фазы: в db_query_phase_seconds и в профиль запроса, если он есть
+class PhaseTimer {
+public:
+    PhaseTimer(Metrics::Histogram& histogram, QueryProfile* profile, QueryProfile::Phase phase)
+        : histogram_(histogram), profile_(profile), phase_(phase), start_(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        histogram_.record(elapsed);
+        if (profile_) profile_->addPhase(phase_, elapsed);
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    Metrics::Histogram& histogram_;
+    QueryProfile* profile_;
+    QueryProfile::Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Состояние одного запроса, общее для всех его операторов
+class QueryContext {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    QueryContext(std::string query_id, std::shared_ptr<QueryMemoryTracker> memory,
+                 std::shared_ptr<QueryRegistry> registry = nullptr)
+        : query_id_(std::move(query_id)), memory_(std::move(memory)), registry_(std::move(registry)) {}
+    ~QueryContext();
+
+    QueryContext(const QueryContext&) = delete;
+    QueryContext& operator=(const QueryContext&) = delete;
+
+    const std::string& queryId() const { return query_id_; }
+    QueryMemoryTracker& memory() const { return *memory_; }
+    Clock::time_point started() const { return started_; }
+
+    // До начала исполнения: операторы плана будут считать строки и время
+    void enableProfile() { profile_ = std::make_unique<QueryProfile>(); }
+    // nullptr — профиль не включён
+    QueryProfile* profile() const { return profile_.get(); }
+
+    // Арена для временных данных оператора или воркера: аренда возвращается
+    // сброшенной, блоки освобождаются вместе с запросом
+    ArenaPool::Lease leaseArena() { return arenas_.acquire(); }
+
+    // Задаётся до начала исполнения
+    void setDeadline(Clock::time_point deadline) { deadline_ = deadline; }
+    // С любого потока; операторы заметят отмену на ближайшей границе пачки
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+    // Операторы вызывают между пачками; бросает QueryCancelled. Исключение
+    // разматывает дерево операторов — их память и блокировки таблиц
+    // освобождаются сразу.
+    void checkCancelled() const {
+        if (cancelled() || (deadline_ != Clock::time_point::max() && Clock::now() >= deadline_)) throwCancelled();
+    }
+
+private:
+    [[noreturn]] void throwCancelled() const;
+
+    std::string query_id_;
+    std::shared_ptr<QueryMemoryTracker> memory_;
+    std::shared_ptr<QueryRegistry> registry_;
+    std::atomic<bool> cancelled_{false};
+    Clock::time_point deadline_ = Clock::time_point::max();
+    Clock::time_point started_ = Clock::now();
+    std::unique_ptr<QueryProfile> profile_;
+    ArenaPool arenas_;
+};
+
+// Исполняющиеся запросы по id — чтобы отменить запрос из другого соединения.
+// Контекст снимается с учёта в деструкторе.
+class QueryRegistry {
+public:
+    // false — запрос с таким id уже исполняется
+    bool add(QueryContext& ctx);
+    void remove(const QueryContext& ctx);
+    // false — такого запроса нет
+    bool cancel(const std::string& query_id);
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, QueryContext*> queries_;
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "query_engine/memory_tracker.h"
+#include "query_engine/value.h"
+#include "storage_engine/file_manager.h"
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Временный файл для вытесненных на диск строк. Сначала только запись,
+// после finishWriting() — последовательное чтение. Файл удаляется в деструкторе.
+//
+// Операторы держат десятки таких файлов разом (партиции grace hash join и
+// агрегации), поэтому открытый дескриптор и буфер есть только у того, кто
+// сейчас пишет или читается: запись копится в буфере и дописывается в файл
+// с открытием на время сброса, чтение открывает файл при первом read() и
+// закрывает в конце. Буфер учитывается в памяти запроса.
+class SpillFile {
+public:
+    SpillFile(FileManager& files, const std::string& tag, QueryMemoryTracker& memory);
+    ~SpillFile();
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    // key — произвольные байты, которые оператор хочет сохранить рядом со строкой
+    // (нормализованный ключ сортировки, хэш и т.п.)
+    void write(std::string_view key, const Row& row);
+    void finishWriting();
+    bool read(std::string& key, Row& row);
+
+    size_t rowCount() const { return rows_; }
+    size_t bytesWritten() const { return bytes_; }
+
+private:
+    size_t acquireBuffer();
+    void releaseBuffer();
+    void flushPending();
+
+    FileManager& files_;
+    std::string path_;
+    MemoryReservation buffer_mem_;
+    std::string pending_; // записи, ещё не дописанные в файл
+    size_t flush_bytes_ = 0;
+    std::ifstream in_;
+    std::vector<char> buffer_; // буфер чтения
+    bool read_done_ = false;
+    size_t rows_ = 0;
+    size_t bytes_ = 0;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include "query_engine/ast.h"
+#include "query_engine/ast_builder.h"
+#include "query_engine/executor.h"
+#include "storage_engine/table_manager.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Запрос разобран, но не сходится с каталогом: нет таблицы или колонки, не тот тип
+class QueryError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+struct StatementResult {
+    std::vector<std::string> columns;
+    std::vector<ColumnType> column_types;
+    // Только SELECT: строки потоком. Держит план и таблицу, пока жив.
+    std::unique_ptr<RowSource> rows;
+    size_t affected_rows = 0;
+    std::string message;
+};
+
+// Разобранный оператор с параметрами ?: разбор один раз, исполнение — много раз
+class PreparedStatement {
+public:
+    size_t parameterCount() const { return parsed_.parameter_count; }
+
+private:
+    friend class SqlEngine;
+    explicit PreparedStatement(ParsedStatement parsed) : parsed_(std::move(parsed)) {}
+
+    ParsedStatement parsed_;
+};
+
+// SQL-текст -> AST -> физический план -> QueryExecutor
+class SqlEngine {
+public:
+    SqlEngine(const QueryExecutor& executor, TableManager& tables) : executor_(executor), tables_(tables) {}
+
+    // Бросает SyntaxError, QueryError и ошибки исполнения (QueryRejected, MemoryLimitExceeded)
+    StatementResult execute(std::string_view sql, std::shared_ptr<QueryContext> ctx = nullptr) const;
+
+    // Бросает SyntaxError
+    std::shared_ptr<const PreparedStatement> prepare(std::string_view sql) const;
+    // parameters подставляются вместо ? по порядку; их число должно совпадать
+    StatementResult execute(const PreparedStatement& statement, const std::vector<Value>& parameters,
+                            std::shared_ptr<QueryContext> ctx = nullptr) const;
+
+private:
+    StatementResult select(const SelectStatement& statement, std::shared_ptr<QueryContext> ctx) const;
+    StatementResult createTable(const CreateTableStatement& statement) const;
+    // ctx прерывает ожидание блокировки таблицы и получает его в профиль; nullptr — без них
+    StatementResult insert(const InsertStatement& statement, const QueryContext* ctx) const;
+
+    std::shared_ptr<ColumnarTable> findTable(const std::string& name) const;
+
+    const QueryExecutor& executor_;
+    TableManager& tables_;
+};
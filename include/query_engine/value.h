@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <variant>
+#include <vector>
+
+using Value = std::variant<std::monostate, int64_t, double, std::string>;
+using Row = std::vector<Value>;
+
+inline bool isNull(const Value& v) {
+    return std::holds_alternative<std::monostate>(v);
+}
+
+inline uint64_t mixHash(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline uint64_t hashValue(const Value& v) {
+    switch (v.index()) {
+        case 1:
+            return mixHash(static_cast<uint64_t>(std::get<int64_t>(v)));
+        case 2: {
+            double d = std::get<double>(v);
+            if (d == 0.0) d = 0.0; // -0.0 и 0.0 должны попадать в один бакет
+            uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(bits));
+            return mixHash(bits ^ 0x9e3779b97f4a7c15ULL);
+        }
+        case 3: {
+            const std::string& s = std::get<std::string>(v);
+            uint64_t h = 0xcbf29ce484222325ULL;
+            for (unsigned char c : s) {
+                h ^= c;
+                h *= 0x100000001b3ULL;
+            }
+            return mixHash(h);
+        }
+        default:
+            return 0;
+    }
+}
+
+inline bool isNumeric(const Value& v) {
+    return v.index() == 1 || v.index() == 2;
+}
+
+inline double toDouble(const Value& v) {
+    return v.index() == 1 ? static_cast<double>(std::get<int64_t>(v)) : std::get<double>(v);
+}
+
+// NULL меньше любого значения; int64 и double сравниваются как числа
+inline int compareValues(const Value& a, const Value& b) {
+    if (isNull(a) || isNull(b)) return isNull(b) - isNull(a);
+    if (a.index() == 1 && b.index() == 1) {
+        const int64_t x = std::get<int64_t>(a), y = std::get<int64_t>(b);
+        return (x > y) - (x < y);
+    }
+    if (isNumeric(a) && isNumeric(b)) {
+        const double x = toDouble(a), y = toDouble(b);
+        return (x > y) - (x < y);
+    }
+    if (a.index() == 3 && b.index() == 3) {
+        const int c = std::get<std::string>(a).compare(std::get<std::string>(b));
+        return (c > 0) - (c < 0);
+    }
+    return a.index() < b.index() ? -1 : 1;
+}
+
+// Приблизительный объём строки в памяти — для бюджетов операторов
+inline size_t estimateRowBytes(const Row& row) {
+    size_t bytes = sizeof(Row) + row.capacity() * sizeof(Value);
+    for (const Value& v : row) {
+        if (v.index() == 3) bytes += std::get<std::string>(v).capacity();
+    }
+    return bytes;
+}
@@ -1,2 +1,21 @@
 #pragma once
-class FileManager {};
\ No newline at end of file
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+class FileManager {
+public:
+    // Пустой temp_dir — подкаталог в системном temp
+    explicit FileManager(std::string temp_dir = "");
+
+    // Создаёт пустой временный файл с уникальным именем и возвращает путь
+    std::string createTempFile(const std::string& tag);
+    void removeFile(const std::string& path) noexcept;
+
+    const std::string& tempDirectory() const { return temp_dir_; }
+
+private:
+    std::string temp_dir_;
+    std::string instance_tag_;
+    std::atomic<uint64_t> counter_{0};
+};
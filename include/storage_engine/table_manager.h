@@ -1,2 +1,104 @@
 #pragma once
-class TableManager {};
\ No newline at end of file
+#include "query_engine/value.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class ColumnType { Int64, Double, String };
+
+// Колонка в типизированном виде: значения подряд в массиве своего типа,
+// строки — общий буфер символов со смещениями, NULL — отдельная маска.
+// Value собирается только в get(), когда строку действительно нужно отдать.
+class Column {
+public:
+    Column(std::string name, ColumnType type) : name_(std::move(name)), type_(type) {}
+
+    // Бросает std::invalid_argument, если значение не приводится к типу колонки
+    void append(const Value& value);
+    Value get(size_t row) const;
+
+    const std::string& name() const { return name_; }
+    ColumnType type() const { return type_; }
+    size_t size() const { return valid_.size(); }
+
+    bool isNull(size_t row) const { return valid_[row] == 0; }
+    // Доступ без сборки Value; вызывать только для не-NULL строк своего типа
+    int64_t int64At(size_t row) const { return ints_[row]; }
+    double doubleAt(size_t row) const { return doubles_[row]; }
+    std::string_view stringAt(size_t row) const {
+        return std::string_view(chars_.data() + offsets_[row], offsets_[row + 1] - offsets_[row]);
+    }
+
+private:
+    std::string name_;
+    ColumnType type_;
+    std::vector<uint8_t> valid_;
+    std::vector<int64_t> ints_;
+    std::vector<double> doubles_;
+    std::vector<char> chars_;
+    std::vector<size_t> offsets_{0};
+};
+
+struct ColumnSpec {
+    std::string name;
+    ColumnType type;
+};
+
+class ColumnarTable {
+public:
+    // Бросает std::invalid_argument на пустое или повторное имя колонки
+    ColumnarTable(std::string name, const std::vector<ColumnSpec>& columns);
+
+    // Бросает std::invalid_argument, если строка не подходит под схему
+    void checkRow(const Row& row) const;
+    // Строка должна содержать значение для каждой колонки
+    void appendRow(const Row& row);
+
+    // Между отрезками ожидания занятой блокировки; бросает, чтобы бросить ждать
+    using LockInterrupt = std::function<void()>;
+
+    // Сканы берут разделяемую блокировку на сборку каждой пачки, вставка — исключительную.
+    // Ожидание занятой блокировки пишется в db_table_lock_wait_seconds
+    // и прибавляется к *waited, если он задан. С interrupt ожидание идёт
+    // отрезками, и между ними interrupt может прервать его исключением.
+    std::shared_lock<std::shared_timed_mutex> lockShared(std::chrono::nanoseconds* waited = nullptr,
+                                                         const LockInterrupt& interrupt = {}) const;
+    std::unique_lock<std::shared_timed_mutex> lockExclusive(std::chrono::nanoseconds* waited = nullptr,
+                                                            const LockInterrupt& interrupt = {});
+
+    const std::string& name() const { return name_; }
+    size_t rowCount() const { return row_count_; }
+    size_t columnCount() const { return columns_.size(); }
+    const Column& column(size_t index) const { return columns_.at(index); }
+    // Бросает std::out_of_range, если колонки нет
+    size_t columnIndex(const std::string& name) const;
+
+private:
+    std::string name_;
+    std::vector<Column> columns_;
+    size_t row_count_ = 0;
+    mutable std::shared_timed_mutex mutex_;
+};
+
+// Каталог таблиц. Запрос держит shared_ptr, поэтому удаление таблицы
+// не мешает уже идущим сканам.
+class TableManager {
+public:
+    // Бросает std::invalid_argument, если таблица уже есть
+    std::shared_ptr<ColumnarTable> createTable(const std::string& name, const std::vector<ColumnSpec>& columns);
+    // nullptr, если таблицы нет
+    std::shared_ptr<ColumnarTable> getTable(const std::string& name) const;
+    bool dropTable(const std::string& name);
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<ColumnarTable>> tables_;
+};
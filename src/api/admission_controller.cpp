@@ -0,0 +1,172 @@
+#include "api/admission_controller.h"
+#include "common/metrics.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    constexpr const char* kPoolBusy = "Server is busy, try again later";
+
+    // reason: overloaded — очередь полна, timeout — истекло ожидание, busy — пул не принял, shutdown
+    void countRejected(const std::string& workload_class, const char* reason) {
+        static auto& rejected = Metrics::registry().counter(
+            "db_admission_rejected_total", "Queries rejected by admission control", {"class", "reason"});
+        rejected.with({workload_class, reason}).inc();
+    }
+}
+
+std::vector<WorkloadClass> defaultWorkloadClasses() {
+    return {
+        {"oltp", 8, 256, std::chrono::milliseconds(1000)},
+        {"analytics", 2, 32, std::chrono::milliseconds(30000)},
+    };
+}
+
+AdmissionController::AdmissionController(std::vector<WorkloadClass> classes, ExecutionPool& pool)
+    : classes_(std::move(classes)), pool_(pool), lanes_(classes_.size()) {
+    if (classes_.empty()) throw std::invalid_argument("At least one workload class is required");
+    for (const WorkloadClass& c : classes_) {
+        if (c.max_concurrent == 0) throw std::invalid_argument("Workload class " + c.name + " admits nothing");
+    }
+    expirer_ = std::thread([this] { expireLoop(); });
+}
+
+AdmissionController::~AdmissionController() { shutdown(); }
+
+void AdmissionController::shutdown() {
+    std::vector<Reject> rejects;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+        for (Lane& lane : lanes_) {
+            for (Pending& p : lane.queue) rejects.push_back(std::move(p.reject));
+            lane.queue.clear();
+        }
+    }
+    changed_.notify_all();
+    expirer_.join();
+    for (const Reject& reject : rejects) reject("Server is shutting down");
+}
+
+std::vector<AdmissionController::LaneStats> AdmissionController::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<LaneStats> stats;
+    stats.reserve(lanes_.size());
+    for (const Lane& lane : lanes_) stats.push_back({lane.running, lane.queue.size()});
+    return stats;
+}
+
+std::optional<size_t> AdmissionController::classIndex(const std::string& name) const {
+    if (name.empty()) return 0;
+    for (size_t i = 0; i < classes_.size(); ++i) {
+        if (classes_[i].name == name) return i;
+    }
+    return std::nullopt;
+}
+
+size_t AdmissionController::totalConcurrency() const {
+    size_t total = 0;
+    for (const WorkloadClass& c : classes_) total += c.max_concurrent;
+    return total;
+}
+
+void AdmissionController::submit(size_t workload_class, Task task, Reject reject) {
+    const WorkloadClass& config = classes_.at(workload_class);
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        Lane& lane = lanes_[workload_class];
+        if (stopping_) {
+            lock.unlock();
+            countRejected(config.name, "shutdown");
+            return reject("Server is shutting down");
+        }
+        if (lane.running >= config.max_concurrent) {
+            if (lane.queue.size() >= config.max_queued) {
+                lock.unlock();
+                countRejected(config.name, "overloaded");
+                return reject("Workload class " + config.name + " is overloaded, try again later");
+            }
+            const bool first = lane.queue.empty();
+            lane.queue.push_back(
+                {std::move(task), std::move(reject), std::chrono::steady_clock::now() + config.queue_timeout});
+            // Срок нового ожидания может оказаться ближайшим
+            if (first) changed_.notify_one();
+            return;
+        }
+        ++lane.running;
+    }
+    if (!dispatch(workload_class, std::move(task))) {
+        release(workload_class);
+        countRejected(config.name, "busy");
+        reject(kPoolBusy);
+    }
+}
+
+bool AdmissionController::dispatch(size_t workload_class, Task task) {
+    // Слот освобождается и при исключении из задачи
+    struct Slot {
+        AdmissionController* self;
+        size_t workload_class;
+        ~Slot() { self->release(workload_class); }
+    };
+    return pool_.trySubmit([this, workload_class, task = std::move(task)] {
+        Slot slot{this, workload_class};
+        task();
+    });
+}
+
+void AdmissionController::release(size_t workload_class) {
+    for (;;) {
+        Pending next;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Lane& lane = lanes_[workload_class];
+            if (lane.queue.empty()) {
+                --lane.running;
+                return;
+            }
+            next = std::move(lane.queue.front());
+            lane.queue.pop_front();
+        }
+        // Слот переходит к следующему; просроченного отклоняем сами, не ждём expireLoop
+        if (std::chrono::steady_clock::now() >= next.deadline) {
+            countRejected(classes_[workload_class].name, "timeout");
+            next.reject("Timed out waiting in the " + classes_[workload_class].name + " queue");
+            continue;
+        }
+        if (dispatch(workload_class, std::move(next.task))) return;
+        countRejected(classes_[workload_class].name, "busy");
+        next.reject(kPoolBusy);
+    }
+}
+
+void AdmissionController::expireLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        const auto now = std::chrono::steady_clock::now();
+        std::vector<std::pair<Reject, std::string>> expired;
+        auto wake = std::chrono::steady_clock::time_point::max();
+        for (size_t i = 0; i < lanes_.size(); ++i) {
+            // Таймаут у класса один, поэтому очередь упорядочена по сроку
+            auto& queue = lanes_[i].queue;
+            while (!queue.empty() && queue.front().deadline <= now) {
+                countRejected(classes_[i].name, "timeout");
+                expired.emplace_back(std::move(queue.front().reject),
+                                     "Timed out waiting in the " + classes_[i].name + " queue");
+                queue.pop_front();
+            }
+            if (!queue.empty()) wake = std::min(wake, queue.front().deadline);
+        }
+        if (!expired.empty()) {
+            lock.unlock();
+            for (const auto& [reject, reason] : expired) reject(reason);
+            lock.lock();
+            continue;
+        }
+        if (wake == std::chrono::steady_clock::time_point::max()) {
+            changed_.wait(lock);
+        } else {
+            changed_.wait_until(lock, wake);
+        }
+    }
+}
@@ -0,0 +1,204 @@
+#include "api/binary_connection.h"
+#include "api/result_encoder.h"
+#include "api/socket_write.h"
+#include "query_engine/lexer.h"
+
+using namespace BinaryProtocol;
+
+namespace {
+    // Исходящие данные копятся до этого размера, потом уходят в сокет
+    constexpr size_t kFlushBytes = 64 * 1024;
+}
+
+void BinaryConnection::read() {
+    socket_.async_read_some(asio::buffer(read_buffer_),
+                            [self = shared_from_this()](const asio::error_code& ec, size_t bytes) {
+                                if (ec) return self->close();
+                                self->in_.append(self->read_buffer_.data(), bytes);
+                                self->admission_.submit(
+                                    0, [self] { self->process(false); },
+                                    [self](const std::string&) { self->process(true); });
+                            });
+}
+
+void BinaryConnection::process(bool rejected) {
+    try {
+        if (!processFrames(rejected)) return close();
+        flush();
+    } catch (const asio::system_error&) {
+        return close();
+    }
+    read();
+}
+
+bool BinaryConnection::processFrames(bool rejected) {
+    size_t pos = 0;
+    while (in_.size() - pos >= kLengthBytes) {
+        Reader header(std::string_view(in_).substr(pos, kLengthBytes));
+        const uint32_t length = header.u32();
+        if (length < 5 || length > kMaxFrameBytes) {
+            writeError(0, ErrorCode::Protocol, "Bad frame length");
+            flush();
+            return false;
+        }
+        if (in_.size() - pos - kLengthBytes < length) break;
+
+        Reader reader(std::string_view(in_).substr(pos + kLengthBytes, length));
+        pos += kLengthBytes + length;
+        const auto type = static_cast<MessageType>(reader.u8());
+        const uint32_t request_id = reader.u32();
+        if (rejected) {
+            writeError(request_id, ErrorCode::Rejected, "Server is busy, try again later");
+            continue;
+        }
+        try {
+            handleFrame(type, request_id, reader);
+        } catch (const ProtocolError& e) {
+            writeError(request_id, ErrorCode::Protocol, e.what());
+            flush();
+            return false;
+        }
+        if (out_.size() >= kFlushBytes) flush();
+    }
+    in_.erase(0, pos);
+    return true;
+}
+
+void BinaryConnection::handleFrame(MessageType type, uint32_t request_id, Reader& reader) {
+    Writer writer(out_);
+    switch (type) {
+        case MessageType::Query: {
+            std::shared_ptr<const PreparedStatement> statement;
+            try {
+                statement = engine_.prepare(reader.rest());
+            } catch (const SyntaxError& e) {
+                return writeError(request_id, ErrorCode::Syntax, e.what());
+            }
+            return runStatement(request_id, *statement, {});
+        }
+        case MessageType::Prepare: {
+            std::shared_ptr<const PreparedStatement> statement;
+            try {
+                statement = engine_.prepare(reader.rest());
+            } catch (const SyntaxError& e) {
+                return writeError(request_id, ErrorCode::Syntax, e.what());
+            }
+            const uint32_t handle = next_handle_++;
+            writer.beginFrame(MessageType::Prepared, request_id);
+            writer.u32(handle);
+            writer.u16(static_cast<uint16_t>(statement->parameterCount()));
+            writer.endFrame();
+            statements_.emplace(handle, std::move(statement));
+            return;
+        }
+        case MessageType::Execute: {
+            const uint32_t handle = reader.u32();
+            std::vector<Value> parameters(reader.u16());
+            for (Value& v : parameters) v = reader.value();
+            auto it = statements_.find(handle);
+            if (it == statements_.end()) {
+                return writeError(request_id, ErrorCode::Query, "Unknown statement handle " + std::to_string(handle));
+            }
+            // Оператор может закрыться, пока идёт исполнение, — держим копию указателя
+            const auto statement = it->second;
+            return runStatement(request_id, *statement, parameters);
+        }
+        case MessageType::CloseStatement: {
+            statements_.erase(reader.u32());
+            writer.beginFrame(MessageType::Complete, request_id);
+            writer.u64(0);
+            writer.shortString("");
+            writer.endFrame();
+            return;
+        }
+        default:
+            throw ProtocolError("Unknown message type " + std::to_string(static_cast<unsigned>(type)));
+    }
+}
+
+void BinaryConnection::runStatement(uint32_t request_id, const PreparedStatement& statement,
+                                    const std::vector<Value>& parameters) {
+    Writer writer(out_);
+    // Начало кадра DataRows, который ещё пишется
+    size_t open_frame = std::string::npos;
+    // Контекст несёт срок statement_timeout и регистрацию для отмены
+    const auto context = executor_.createContext();
+    try {
+        StatementResult result = engine_.execute(statement, parameters, context);
+        if (!result.rows) {
+            writer.beginFrame(MessageType::Complete, request_id);
+            writer.u64(result.affected_rows);
+            writer.shortString(result.message);
+            writer.endFrame();
+            return;
+        }
+
+        writer.beginFrame(MessageType::RowDescription, request_id);
+        writer.u16(static_cast<uint16_t>(result.columns.size()));
+        for (size_t i = 0; i < result.columns.size(); ++i) {
+            writer.u8(columnTypeCode(result.column_types[i]));
+            writer.shortString(result.columns[i]);
+        }
+        writer.endFrame();
+
+        uint64_t total = 0;
+        Row row;
+        bool more = result.rows->next(row);
+        while (more) {
+            open_frame = out_.size();
+            writer.beginFrame(MessageType::DataRows, request_id);
+            const size_t count_pos = out_.size();
+            writer.u32(0);
+            uint32_t count = 0;
+            const size_t batch_start = out_.size();
+            do {
+                for (const Value& v : row) writer.value(v);
+                ++count;
+                more = result.rows->next(row);
+            } while (more && out_.size() - batch_start < kFlushBytes);
+            for (size_t i = 0; i < 4; ++i) out_[count_pos + i] = static_cast<char>(count >> (8 * i));
+            writer.endFrame();
+            open_frame = std::string::npos;
+            total += count;
+            if (out_.size() >= kFlushBytes) flush();
+        }
+
+        writer.beginFrame(MessageType::Complete, request_id);
+        writer.u64(total);
+        writer.shortString("");
+        writer.endFrame();
+    } catch (const asio::system_error&) {
+        // Клиент не читает ответ или ушёл: параллельные части запроса останавливаются
+        context->cancel();
+        throw;
+    } catch (const std::exception& e) {
+        // Недописанный кадр отбрасывается; уже отправленные DataRows клиент
+        // отбросит сам, получив Error вместо Complete
+        if (open_frame != std::string::npos) out_.resize(open_frame);
+        ErrorCode code = ErrorCode::Internal;
+        if (dynamic_cast<const QueryError*>(&e)) code = ErrorCode::Query;
+        if (dynamic_cast<const QueryRejected*>(&e)) code = ErrorCode::Rejected;
+        if (dynamic_cast<const QueryCancelled*>(&e)) code = ErrorCode::Cancelled;
+        writeError(request_id, code, e.what());
+    }
+}
+
+void BinaryConnection::writeError(uint32_t request_id, ErrorCode code, std::string_view message) {
+    Writer writer(out_);
+    writer.beginFrame(MessageType::Error, request_id);
+    writer.u16(static_cast<uint16_t>(code));
+    writer.shortString(message);
+    writer.endFrame();
+}
+
+void BinaryConnection::flush() {
+    if (out_.empty()) return;
+    writeWithDeadline(socket_, {asio::buffer(out_)}, write_timeout_);
+    out_.clear();
+}
+
+void BinaryConnection::close() {
+    asio::error_code ec;
+    socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+    socket_.close(ec);
+}
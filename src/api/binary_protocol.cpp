@@ -0,0 +1,114 @@
+#include "api/binary_protocol.h"
+#include <algorithm>
+#include <cstring>
+
+namespace BinaryProtocol {
+    void Writer::beginFrame(MessageType type, uint32_t request_id) {
+        frame_start_ = out_.size();
+        u32(0);
+        u8(static_cast<uint8_t>(type));
+        u32(request_id);
+    }
+
+    void Writer::endFrame() {
+        const auto length = static_cast<uint32_t>(out_.size() - frame_start_ - kLengthBytes);
+        for (size_t i = 0; i < kLengthBytes; ++i) {
+            out_[frame_start_ + i] = static_cast<char>(length >> (8 * i));
+        }
+    }
+
+    void Writer::u16(uint16_t v) {
+        const char bytes[] = {static_cast<char>(v), static_cast<char>(v >> 8)};
+        out_.append(bytes, sizeof(bytes));
+    }
+
+    void Writer::u32(uint32_t v) {
+        const char bytes[] = {static_cast<char>(v), static_cast<char>(v >> 8), static_cast<char>(v >> 16),
+                              static_cast<char>(v >> 24)};
+        out_.append(bytes, sizeof(bytes));
+    }
+
+    void Writer::u64(uint64_t v) {
+        u32(static_cast<uint32_t>(v));
+        u32(static_cast<uint32_t>(v >> 32));
+    }
+
+    void Writer::shortString(std::string_view s) {
+        const size_t n = std::min<size_t>(s.size(), UINT16_MAX);
+        u16(static_cast<uint16_t>(n));
+        out_.append(s.data(), n);
+    }
+
+    void Writer::value(const Value& v) {
+        switch (v.index()) {
+            case 1:
+                u8(1);
+                u64(static_cast<uint64_t>(std::get<int64_t>(v)));
+                break;
+            case 2: {
+                u8(2);
+                uint64_t bits;
+                const double d = std::get<double>(v);
+                std::memcpy(&bits, &d, sizeof(bits));
+                u64(bits);
+                break;
+            }
+            case 3: {
+                const std::string& s = std::get<std::string>(v);
+                u8(3);
+                u32(static_cast<uint32_t>(s.size()));
+                out_ += s;
+                break;
+            }
+            default:
+                u8(0);
+        }
+    }
+
+    std::string_view Reader::take(size_t n) {
+        if (data_.size() - pos_ < n) throw ProtocolError("Truncated message");
+        const std::string_view bytes = data_.substr(pos_, n);
+        pos_ += n;
+        return bytes;
+    }
+
+    uint8_t Reader::u8() {
+        return static_cast<uint8_t>(take(1)[0]);
+    }
+
+    uint16_t Reader::u16() {
+        const std::string_view b = take(2);
+        return static_cast<uint16_t>(static_cast<uint8_t>(b[0]) | static_cast<uint8_t>(b[1]) << 8);
+    }
+
+    uint32_t Reader::u32() {
+        const std::string_view b = take(4);
+        uint32_t v = 0;
+        for (int i = 3; i >= 0; --i) v = (v << 8) | static_cast<uint8_t>(b[i]);
+        return v;
+    }
+
+    uint64_t Reader::u64() {
+        const uint64_t low = u32();
+        return low | static_cast<uint64_t>(u32()) << 32;
+    }
+
+    Value Reader::value() {
+        switch (u8()) {
+            case 0: return Value{};
+            case 1: return static_cast<int64_t>(u64());
+            case 2: {
+                const uint64_t bits = u64();
+                double d;
+                std::memcpy(&d, &bits, sizeof(d));
+                return d;
+            }
+            case 3: return std::string(take(u32()));
+            default: throw ProtocolError("Unknown value tag");
+        }
+    }
+
+    std::string_view Reader::rest() {
+        return take(data_.size() - pos_);
+    }
+}
@@ -0,0 +1,150 @@
+#include "api/compression.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <zlib.h>
+#ifdef DB_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+    constexpr size_t kOutputStep = 16 * 1024;
+
+    std::string_view trim(std::string_view s) {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+        return s;
+    }
+
+    bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                   return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+               });
+    }
+
+    // gzip-обёртка deflate: windowBits 15 + 16
+    class GzipCompressor : public StreamCompressor {
+    public:
+        explicit GzipCompressor(int level) {
+            if (level == 0) level = Z_DEFAULT_COMPRESSION;
+            level = std::min(level, Z_BEST_COMPRESSION);
+            if (deflateInit2(&stream_, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                throw std::runtime_error("deflateInit2 failed");
+            }
+        }
+
+        ~GzipCompressor() override { deflateEnd(&stream_); }
+
+        void write(std::string_view data, std::string& out) override { run(data, Z_SYNC_FLUSH, out); }
+        void finish(std::string& out) override { run({}, Z_FINISH, out); }
+
+    private:
+        void run(std::string_view data, int flush, std::string& out) {
+            stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+            stream_.avail_in = static_cast<uInt>(data.size());
+            // Выход кончился раньше, чем вход и сброс, — avail_out == 0; иначе всё отдано
+            do {
+                const size_t old_size = out.size();
+                out.resize(old_size + kOutputStep);
+                stream_.next_out = reinterpret_cast<Bytef*>(&out[old_size]);
+                stream_.avail_out = static_cast<uInt>(kOutputStep);
+                const int rc = deflate(&stream_, flush);
+                out.resize(old_size + kOutputStep - stream_.avail_out);
+                if (rc == Z_STREAM_ERROR) throw std::runtime_error("deflate failed");
+            } while (stream_.avail_out == 0);
+        }
+
+        z_stream stream_{};
+    };
+
+#ifdef DB_HAVE_ZSTD
+    class ZstdCompressor : public StreamCompressor {
+    public:
+        explicit ZstdCompressor(int level) : ctx_(ZSTD_createCCtx()) {
+            if (!ctx_) throw std::runtime_error("ZSTD_createCCtx failed");
+            if (level == 0) level = ZSTD_CLEVEL_DEFAULT;
+            ZSTD_CCtx_setParameter(ctx_, ZSTD_c_compressionLevel, std::min(level, ZSTD_maxCLevel()));
+        }
+
+        ~ZstdCompressor() override { ZSTD_freeCCtx(ctx_); }
+
+        void write(std::string_view data, std::string& out) override { run(data, ZSTD_e_flush, out); }
+        void finish(std::string& out) override { run({}, ZSTD_e_end, out); }
+
+    private:
+        void run(std::string_view data, ZSTD_EndDirective mode, std::string& out) {
+            ZSTD_inBuffer in{data.data(), data.size(), 0};
+            size_t remaining;
+            do {
+                const size_t old_size = out.size();
+                out.resize(old_size + kOutputStep);
+                ZSTD_outBuffer output{&out[old_size], kOutputStep, 0};
+                remaining = ZSTD_compressStream2(ctx_, &output, &in, mode);
+                out.resize(old_size + output.pos);
+                if (ZSTD_isError(remaining)) throw std::runtime_error(ZSTD_getErrorName(remaining));
+            } while (remaining != 0);
+        }
+
+        ZSTD_CCtx* ctx_;
+    };
+#endif
+
+#ifdef DB_HAVE_ZSTD
+    constexpr bool kHaveZstd = true;
+#else
+    constexpr bool kHaveZstd = false;
+#endif
+}
+
+const char* encodingName(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::Gzip: return "gzip";
+        case ContentEncoding::Zstd: return "zstd";
+        case ContentEncoding::Identity: break;
+    }
+    return "identity";
+}
+
+ContentEncoding negotiateEncoding(const std::string& accept_encoding) {
+    // q каждой кодировки: -1 — не упомянута
+    double q_gzip = -1;
+    double q_zstd = -1;
+    double q_any = -1;
+    std::string_view rest = accept_encoding;
+    while (!rest.empty()) {
+        const size_t comma = rest.find(',');
+        std::string_view item = trim(rest.substr(0, comma));
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+
+        double q = 1;
+        const size_t semicolon = item.find(';');
+        if (semicolon != std::string_view::npos) {
+            const std::string_view param = trim(item.substr(semicolon + 1));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                q = std::strtod(std::string(param.substr(2)).c_str(), nullptr);
+            }
+            item = trim(item.substr(0, semicolon));
+        }
+        if (equalsIgnoreCase(item, "gzip") || equalsIgnoreCase(item, "x-gzip")) q_gzip = q;
+        if (equalsIgnoreCase(item, "zstd")) q_zstd = q;
+        if (item == "*") q_any = q;
+    }
+    if (q_gzip < 0) q_gzip = q_any;
+    if (q_zstd < 0) q_zstd = q_any;
+    if (!kHaveZstd) q_zstd = -1;
+
+    if (q_zstd > 0 && q_zstd >= q_gzip) return ContentEncoding::Zstd;
+    if (q_gzip > 0) return ContentEncoding::Gzip;
+    return ContentEncoding::Identity;
+}
+
+std::unique_ptr<StreamCompressor> makeCompressor(ContentEncoding encoding, int level) {
+    switch (encoding) {
+        case ContentEncoding::Gzip: return std::make_unique<GzipCompressor>(level);
+#ifdef DB_HAVE_ZSTD
+        case ContentEncoding::Zstd: return std::make_unique<ZstdCompressor>(level);
+#endif
+        default: return nullptr;
+    }
+}
@@ -0,0 +1,55 @@
+#include "api/cursor_manager.h"
+#include <vector>
+
+bool CursorManager::open(std::shared_ptr<Cursor> cursor) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cursors_.size() >= max_open_) return false;
+    const std::string id = cursor->ctx->queryId();
+    // id уникален, пока жив контекст запроса: QueryExecutor не выдаст его второй раз
+    cursors_[id] = {std::move(cursor), std::chrono::steady_clock::now()};
+    return true;
+}
+
+std::shared_ptr<Cursor> CursorManager::find(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cursors_.find(id);
+    if (it == cursors_.end()) return nullptr;
+    it->second.last_used = std::chrono::steady_clock::now();
+    return it->second.cursor;
+}
+
+size_t CursorManager::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cursors_.size();
+}
+
+bool CursorManager::close(const std::string& id) {
+    std::shared_ptr<Cursor> closed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = cursors_.find(id);
+        if (it == cursors_.end()) return false;
+        closed = std::move(it->second.cursor);
+        cursors_.erase(it);
+    }
+    // Дерево операторов разрушается вне блокировки: удаление файлов спилла не быстрое
+    return true;
+}
+
+void CursorManager::closeIdle() {
+    std::vector<std::shared_ptr<Cursor>> closed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto deadline = std::chrono::steady_clock::now() - idle_timeout_;
+        for (auto it = cursors_.begin(); it != cursors_.end();) {
+            Cursor& cursor = *it->second.cursor;
+            if (it->second.last_used > deadline || !cursor.mutex.try_lock()) {
+                ++it;
+                continue;
+            }
+            cursor.mutex.unlock();
+            closed.push_back(std::move(it->second.cursor));
+            it = cursors_.erase(it);
+        }
+    }
+}
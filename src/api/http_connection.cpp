@@ -0,0 +1,265 @@
+#include "api/http_connection.h"
+#include "api/socket_write.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+
+namespace {
+    // Строка запроса и заголовки; длиннее — 431
+    constexpr size_t kMaxHeaderBytes = 64 * 1024;
+
+    std::string toLower(std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return s;
+    }
+
+    std::string_view trim(std::string_view s) {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+        return s;
+    }
+
+    // false — запрос не разбирается
+    bool parseHead(std::string_view head, HttpRequest& request) {
+        size_t line_end = head.find("\r\n");
+        const std::string_view request_line = head.substr(0, line_end);
+        const size_t sp1 = request_line.find(' ');
+        const size_t sp2 = request_line.rfind(' ');
+        if (sp1 == std::string_view::npos || sp2 == sp1) return false;
+        request.method = std::string(request_line.substr(0, sp1));
+        request.target = std::string(request_line.substr(sp1 + 1, sp2 - sp1 - 1));
+        request.version = std::string(request_line.substr(sp2 + 1));
+        if (request.version.rfind("HTTP/1.", 0) != 0 || request.target.empty()) return false;
+        request.path = request.target.substr(0, request.target.find('?'));
+
+        while (line_end != std::string_view::npos) {
+            const size_t start = line_end + 2;
+            line_end = head.find("\r\n", start);
+            const std::string_view line = head.substr(start, line_end == std::string_view::npos ? line_end
+                                                                                                 : line_end - start);
+            if (line.empty()) continue;
+            const size_t colon = line.find(':');
+            if (colon == std::string_view::npos || colon == 0) return false;
+            request.headers[toLower(std::string(line.substr(0, colon)))] = std::string(trim(line.substr(colon + 1)));
+        }
+        return true;
+    }
+}
+
+const char* httpStatusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "Unknown";
+    }
+}
+
+const std::string& HttpRequest::header(const std::string& name) const {
+    static const std::string kEmpty;
+    auto it = headers.find(name);
+    return it == headers.end() ? kEmpty : it->second;
+}
+
+std::string HttpRequest::queryParam(std::string_view name) const {
+    const size_t question = target.find('?');
+    if (question == std::string::npos) return {};
+    std::string_view query = std::string_view(target).substr(question + 1);
+    while (!query.empty()) {
+        const size_t amp = query.find('&');
+        const std::string_view pair = query.substr(0, amp);
+        const size_t eq = pair.find('=');
+        if (pair.substr(0, eq) == name) return eq == std::string_view::npos ? "" : std::string(pair.substr(eq + 1));
+        if (amp == std::string_view::npos) break;
+        query.remove_prefix(amp + 1);
+    }
+    return {};
+}
+
+bool HttpRequest::keepAlive() const {
+    const std::string connection = toLower(header("connection"));
+    if (version == "HTTP/1.0") return connection == "keep-alive";
+    return connection != "close";
+}
+
+void HttpResponseWriter::setHeader(std::string name, std::string value) {
+    extra_headers_.emplace_back(std::move(name), std::move(value));
+}
+
+std::string HttpResponseWriter::head(int status, std::string_view content_type) const {
+    std::string out = "HTTP/1.1 " + std::to_string(status) + " " + httpStatusText(status) + "\r\n";
+    out += "Content-Type: ";
+    out += content_type;
+    out += "\r\n";
+    out += keep_alive_ ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    for (const auto& [name, value] : extra_headers_) out += name + ": " + value + "\r\n";
+    return out;
+}
+
+void HttpResponseWriter::write(const std::vector<asio::const_buffer>& buffers) {
+    writeWithDeadline(socket_, buffers, write_timeout_);
+}
+
+void HttpResponseWriter::send(int status, std::string_view content_type, std::string_view body) {
+    std::string out = head(status, content_type);
+    out += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+    headers_sent_ = true;
+    status_ = status;
+    write({asio::buffer(out), asio::buffer(body.data(), body.size())});
+    complete_ = true;
+}
+
+void HttpResponseWriter::beginChunked(int status, std::string_view content_type) {
+    std::string out = head(status, content_type);
+    out += "Transfer-Encoding: chunked\r\n\r\n";
+    headers_sent_ = true;
+    status_ = status;
+    write({asio::buffer(out)});
+}
+
+void HttpResponseWriter::writeChunk(std::string_view data) {
+    // Пустой chunk означал бы конец ответа
+    if (data.empty()) return;
+    char size_line[32];
+    const int n = std::snprintf(size_line, sizeof(size_line), "%zx\r\n", data.size());
+    write({asio::buffer(size_line, static_cast<size_t>(n)), asio::buffer(data.data(), data.size()),
+           asio::buffer("\r\n", 2)});
+}
+
+void HttpResponseWriter::endChunked() {
+    write({asio::buffer("0\r\n\r\n", 5)});
+    complete_ = true;
+}
+
+HttpExchange::HttpExchange(std::shared_ptr<HttpConnection> connection, HttpRequest request, bool keep_alive)
+    : connection_(std::move(connection)), request_(std::move(request)),
+      response_(connection_->socket_, keep_alive, connection_->options_.write_timeout) {}
+
+HttpExchange::~HttpExchange() {
+    if (!response_.headersSent()) {
+        try {
+            response_.send(500, "text/plain", "No response");
+        } catch (const std::exception&) {
+        }
+    }
+    if (on_complete_) on_complete_(response_.status(), std::chrono::steady_clock::now() - started_);
+    // Незавершённый chunked-ответ: клиент увидит обрыв, а не неполный JSON как целый
+    const bool reuse = response_.complete() && response_.keepAlive();
+    auto connection = std::move(connection_);
+    asio::post(connection->socket_.get_executor(), [connection, reuse] {
+        if (reuse) {
+            connection->readHeaders();
+        } else {
+            connection->close();
+        }
+    });
+}
+
+HttpConnection::HttpConnection(asio::ip::tcp::socket socket, std::shared_ptr<const Handler> handler, Options options)
+    : socket_(std::move(socket)), handler_(std::move(handler)), options_(options),
+      buffer_(kMaxHeaderBytes + options.max_body_bytes), idle_timer_(socket_.get_executor()) {}
+
+// Запрос должен прийти целиком, пока не сработал таймер; иначе соединение закрывается
+void HttpConnection::armIdleTimer() {
+    if (options_.idle_timeout.count() == 0) return;
+    idle_timer_.expires_after(options_.idle_timeout);
+    idle_timer_.async_wait([self = shared_from_this()](const asio::error_code& ec) {
+        if (!ec && !self->in_request_) self->close();
+    });
+}
+
+void HttpConnection::readHeaders() {
+    in_request_ = false;
+    armIdleTimer();
+    asio::async_read_until(socket_, buffer_, "\r\n\r\n",
+                           [self = shared_from_this()](const asio::error_code& ec, size_t bytes) {
+                               if (!ec) {
+                                   self->onHeaders(bytes);
+                               } else if (ec == asio::error::not_found) {
+                                   self->reject(431, "Request headers are too large");
+                               } else {
+                                   self->close();
+                               }
+                           });
+}
+
+void HttpConnection::onHeaders(size_t header_bytes) {
+    auto request = std::make_shared<HttpRequest>();
+    {
+        const auto begin = asio::buffers_begin(buffer_.data());
+        const std::string head(begin, begin + static_cast<std::ptrdiff_t>(header_bytes));
+        buffer_.consume(header_bytes);
+        if (header_bytes > kMaxHeaderBytes) return reject(431, "Request headers are too large");
+        if (!parseHead(head, *request)) return reject(400, "Malformed request");
+    }
+    if (!request->header("transfer-encoding").empty()) {
+        return reject(501, "Chunked request bodies are not supported");
+    }
+
+    size_t length = 0;
+    const std::string& content_length = request->header("content-length");
+    if (!content_length.empty()) {
+        if (!std::all_of(content_length.begin(), content_length.end(),
+                         [](unsigned char c) { return std::isdigit(c); }) ||
+            content_length.size() > 18) {
+            return reject(400, "Malformed Content-Length");
+        }
+        length = std::stoull(content_length);
+    }
+    if (length > options_.max_body_bytes) return reject(413, "Request body is too large");
+
+    if (buffer_.size() >= length) {
+        const auto begin = asio::buffers_begin(buffer_.data());
+        request->body.assign(begin, begin + static_cast<std::ptrdiff_t>(length));
+        buffer_.consume(length);
+        return dispatch(std::move(*request));
+    }
+    asio::async_read(socket_, buffer_, asio::transfer_exactly(length - buffer_.size()),
+                     [self = shared_from_this(), request, length](const asio::error_code& ec, size_t) {
+                         if (ec) return self->close();
+                         const auto begin = asio::buffers_begin(self->buffer_.data());
+                         request->body.assign(begin, begin + static_cast<std::ptrdiff_t>(length));
+                         self->buffer_.consume(length);
+                         self->dispatch(std::move(*request));
+                     });
+}
+
+void HttpConnection::dispatch(HttpRequest request) {
+    in_request_ = true;
+    idle_timer_.cancel();
+    const bool keep_alive = options_.keep_alive && request.keepAlive();
+    auto exchange = std::make_shared<HttpExchange>(shared_from_this(), std::move(request), keep_alive);
+    try {
+        (*handler_)(std::move(exchange));
+    } catch (const std::exception& e) {
+        // Обмен уже уничтожен: если ответа не было, клиент получил 500
+        std::cerr << "Request handler failed: " << e.what() << std::endl;
+    }
+}
+
+void HttpConnection::reject(int status, std::string_view message) {
+    HttpResponseWriter writer(socket_, false);
+    try {
+        writer.send(status, "text/plain", message);
+    } catch (const asio::system_error&) {
+    }
+    close();
+}
+
+void HttpConnection::close() {
+    idle_timer_.cancel();
+    asio::error_code ec;
+    socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+    socket_.close(ec);
+}
@@ -1,9 +1,124 @@
 #include "api/http_server.h"
+#include "api/binary_connection.h"
+#include "api/http_connection.h"
 #include "api/json_handler.h"
-#include "crow.h"
+#include "api/result_encoder.h"
+#include "common/metrics.h"
+#include "query_engine/lexer.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <csignal>
+#include <functional>
 #include <iostream>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
 
-HttpServer::HttpServer() {
+namespace {
+    // Порядка нескольких сотен строк на chunk: накладные расходы на chunk не заметны
+    constexpr size_t kStreamChunkBytes = 64 * 1024;
+    // Первая пачка уходит сразу, дальше chunk копится до kStreamChunkBytes,
+    // но не дольше этого: медленный запрос не молчит, набирая 64 KB
+    constexpr auto kStreamFlushInterval = std::chrono::milliseconds(100);
+
+    constexpr const char* kJson = "application/json";
+    constexpr const char* kQueryPrefix = "/api/query/";
+
+    constexpr const char* kCursorPrefix = "/api/cursor/";
+
+    // Строки тянутся из исполнителя пачками: часы читаются на пачку, а не на строку,
+    // и время исполнения отделяется от времени сериализации
+    constexpr size_t kTimedBatchRows = 1024;
+
+    using Clock = std::chrono::steady_clock;
+
+    // До limit строк в batch; false — источник исчерпан
+    bool pullRows(RowSource& rows, std::vector<Row>& batch, size_t limit) {
+        batch.clear();
+        Row row;
+        while (batch.size() < limit) {
+            if (!rows.next(row)) return false;
+            batch.push_back(std::move(row));
+        }
+        return true;
+    }
+
+    // Метка маршрута без id: число рядов метрики не растёт с числом запросов
+    const char* routeLabel(const std::string& path) {
+        if (path == "/") return "/";
+        if (path == "/api/query") return "/api/query";
+        if (path.rfind(kQueryPrefix, 0) == 0) return "/api/query/:id";
+        if (path == "/api/cursor") return "/api/cursor";
+        if (path.rfind(kCursorPrefix, 0) == 0) return "/api/cursor/:id";
+        if (path == "/api/memory") return "/api/memory";
+        if (path == "/metrics") return "/metrics";
+        return "other";
+    }
+
+    void recordRequest(const char* route, int status, Clock::duration elapsed) {
+        static auto& duration = Metrics::registry().histogram(
+            "http_request_duration_seconds", "HTTP request latency, from parsed request to sent response",
+            {"route", "status"});
+        char code[8];
+        const auto end = std::to_chars(code, code + sizeof(code), status).ptr;
+        duration.with({route, std::string_view(code, end - code)}).record(elapsed);
+    }
+
+    // Неотрицательное десятичное число из заголовка или query string; nullopt — не число
+    std::optional<size_t> parseCount(const std::string& text) {
+        if (text.empty() || text.size() > 12 ||
+            !std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            return std::nullopt;
+        }
+        return static_cast<size_t>(std::stoull(text));
+    }
+
+    // Статус ответа на ошибку исполнения запроса
+    int errorStatus(const std::exception& e) {
+        if (dynamic_cast<const SyntaxError*>(&e) || dynamic_cast<const QueryError*>(&e)) return 400;
+        if (dynamic_cast<const QueryRejected*>(&e)) return 503;
+        if (auto* cancelled = dynamic_cast<const QueryCancelled*>(&e)) return cancelled->timedOut() ? 504 : 409;
+        return 500;
+    }
+
+    // Каждое соединение — на своём strand: таймер простоя и чтение не пересекаются
+    void acceptLoop(asio::ip::tcp::acceptor& acceptor, std::shared_ptr<const HttpConnection::Handler> handler,
+                    HttpConnection::Options options) {
+        auto on_accept = [&acceptor, handler, options](const asio::error_code& ec, asio::ip::tcp::socket socket) {
+            if (!acceptor.is_open()) return;
+            if (!ec) std::make_shared<HttpConnection>(std::move(socket), handler, options)->start();
+            acceptLoop(acceptor, handler, options);
+        };
+        acceptor.async_accept(asio::make_strand(acceptor.get_executor()), on_accept);
+    }
+
+    void acceptBinaryLoop(asio::ip::tcp::acceptor& acceptor, const SqlEngine& engine, const QueryExecutor& executor,
+                          AdmissionController& admission, std::chrono::seconds write_timeout) {
+        auto on_accept = [&acceptor, &engine, &executor, &admission, write_timeout](const asio::error_code& ec,
+                                                                                    asio::ip::tcp::socket socket) {
+            if (!acceptor.is_open()) return;
+            if (!ec) {
+                socket.set_option(asio::ip::tcp::no_delay(true));
+                std::make_shared<BinaryConnection>(std::move(socket), engine, executor, admission, write_timeout)
+                    ->start();
+            }
+            acceptBinaryLoop(acceptor, engine, executor, admission, write_timeout);
+        };
+        acceptor.async_accept(on_accept);
+    }
+}
+
+HttpServer::HttpServer(ServerConfig config)
+    : config_(std::move(config)), executor_(executorConfig(config_)),
+      cursors_(config_.max_open_cursors, std::chrono::seconds(config_.cursor_idle_timeout_seconds)),
+      slow_log_(config_.slow_query_log.empty()
+                    ? nullptr
+                    : std::make_unique<SlowQueryLog>(config_.slow_query_log,
+                                                     std::chrono::milliseconds(config_.slow_query_threshold_ms))),
+      admission_(config_.workload_classes, execution_),
+      execution_(executionThreads(), config_.execution_queue_size) {
     std::cout << "HTTP Server created." << std::endl;
 }
 
@@ -11,23 +126,440 @@ HttpServer::~HttpServer() {
     std::cout << "HTTP Server destroyed." << std::endl;
 }
 
+ExecutorConfig HttpServer::executorConfig(const ServerConfig& config) {
+    ExecutorConfig executor = config.executor;
+    executor.num_threads = config.worker_threads;
+    return executor;
+}
+
+size_t HttpServer::executionThreads() const {
+    return config_.execution_threads != 0 ? config_.execution_threads : admission_.totalConcurrency();
+}
+
 void HttpServer::run() {
-    crow::SimpleApp app;
+    asio::io_context io;
+    asio::ip::tcp::acceptor acceptor(io, asio::ip::tcp::endpoint(asio::ip::tcp::v4(), config_.port));
+    HttpConnection::Options options;
+    options.max_body_bytes = config_.max_body_bytes;
+    options.keep_alive = config_.keep_alive;
+    options.idle_timeout = std::chrono::seconds(config_.keep_alive_timeout_seconds);
+    options.write_timeout = std::chrono::seconds(config_.write_timeout_seconds);
+    acceptLoop(acceptor,
+               std::make_shared<const HttpConnection::Handler>(
+                   [this](std::shared_ptr<HttpExchange> exchange) { handleRequest(std::move(exchange)); }),
+               options);
 
-    CROW_ROUTE(app, "/api/query").methods("POST"_method)
-    ([](const crow::request& req) {
-        std::string sql_query = req.body;
-        if (sql_query.empty()) {
-            return crow::response(400, JsonHandler::serializeError("Query cannot be empty."));
-        }
+    asio::ip::tcp::acceptor binary_acceptor(io);
+    if (config_.binary_port != 0) {
+        binary_acceptor =
+            asio::ip::tcp::acceptor(io, asio::ip::tcp::endpoint(asio::ip::tcp::v4(), config_.binary_port));
+        acceptBinaryLoop(binary_acceptor, engine_, executor_, admission_,
+                         std::chrono::seconds(config_.write_timeout_seconds));
+        std::cout << "Binary protocol on port " << config_.binary_port << std::endl;
+    }
+
+    asio::steady_timer cursor_sweep(io);
+    std::function<void()> sweep_cursors = [&] {
+        cursor_sweep.expires_after(std::chrono::seconds(1));
+        cursor_sweep.async_wait([&](const asio::error_code& ec) {
+            if (ec) return;
+            cursors_.closeIdle();
+            sweep_cursors();
+        });
+    };
+    sweep_cursors();
 
-        std::cout << "Received query: " << sql_query << std::endl;
-        
-        // ЗАГЛУШКА: В будущем здесь будет вызов Query Engine
+    // Отказы ожидающим и доработка принятых пишут в сокеты со сроком — через
+    // асинхронную запись, поэтому io останавливается только после них
+    std::thread stopper;
+    asio::signal_set signals(io, SIGINT, SIGTERM);
+    signals.async_wait([&](const asio::error_code&, int) {
+        acceptor.close();
+        binary_acceptor.close();
+        cursor_sweep.cancel();
+        stopper = std::thread([&] {
+            admission_.shutdown();
+            execution_.shutdown();
+            io.stop();
+        });
+    });
+
+    const size_t threads = config_.io_threads != 0 ? config_.io_threads
+                                                   : std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Database Server is running on http://localhost:" << config_.port << " (" << threads
+              << " IO threads, " << execution_.threadCount() << " execution threads, " << executor_.threadCount()
+              << " worker threads)" << std::endl;
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; ++i) pool.emplace_back([&io] { io.run(); });
+    io.run();
+    for (auto& t : pool) t.join();
+    if (stopper.joinable()) stopper.join();
+    // Обработчики, поставленные запросами при завершении, закрывают соединения
+    io.restart();
+    io.poll();
+}
 
-        return crow::response(200, JsonHandler::serializeSuccess("Query received: " + sql_query));
+void HttpServer::handleRequest(std::shared_ptr<HttpExchange> exchange) {
+    const HttpRequest& req = exchange->request();
+    HttpResponseWriter& res = exchange->response();
+    exchange->onComplete([route = routeLabel(req.path)](int status, Clock::duration elapsed) {
+        recordRequest(route, status, elapsed);
     });
+    if (req.path == "/") return res.send(200, "text/plain", "Database Server is running!");
+    if (req.path == "/api/query") {
+        if (req.method != "POST") return res.send(405, kJson, JsonHandler::serializeError("Use POST"));
+        return submit(std::move(exchange), &HttpServer::handleQuery);
+    }
+    if (req.path.rfind(kQueryPrefix, 0) == 0) {
+        // DELETE /api/query/<id>: отмена, в обход очередей допуска
+        if (req.method != "DELETE") return res.send(405, kJson, JsonHandler::serializeError("Use DELETE"));
+        const std::string query_id = req.path.substr(std::string_view(kQueryPrefix).size());
+        if (!executor_.cancel(query_id)) {
+            return res.send(404, kJson, JsonHandler::serializeError("No running query " + query_id));
+        }
+        return res.send(200, kJson, JsonHandler::serializeSuccess("Query " + query_id + " cancelled"));
+    }
+    if (req.path == "/api/cursor") {
+        if (req.method != "POST") return res.send(405, kJson, JsonHandler::serializeError("Use POST"));
+        return submit(std::move(exchange), &HttpServer::handleOpenCursor);
+    }
+    if (req.path.rfind(kCursorPrefix, 0) == 0) {
+        if (req.method == "GET") return submit(std::move(exchange), &HttpServer::handleFetchCursor);
+        if (req.method != "DELETE") return res.send(405, kJson, JsonHandler::serializeError("Use GET or DELETE"));
+        const std::string cursor_id = req.path.substr(std::string_view(kCursorPrefix).size());
+        if (!cursors_.close(cursor_id)) {
+            return res.send(404, kJson, JsonHandler::serializeError("No open cursor " + cursor_id));
+        }
+        return res.send(200, kJson, JsonHandler::serializeSuccess("Cursor " + cursor_id + " closed"));
+    }
+    if (req.path == "/api/memory") {
+        if (req.method != "GET") return res.send(405, kJson, JsonHandler::serializeError("Use GET"));
+        const MemoryGovernor& governor = executor_.memoryGovernor();
+        return res.send(200, kJson, JsonHandler::serializeMemoryUsage(governor.snapshot(), governor.used(),
+                                                                      governor.limit()));
+    }
+    if (req.path == "/metrics") {
+        if (req.method != "GET") return res.send(405, kJson, JsonHandler::serializeError("Use GET"));
+        return res.send(200, "text/plain; version=0.0.4", renderMetrics());
+    }
+    res.send(404, kJson, JsonHandler::serializeError("Not found: " + req.path));
+}
+
+std::string HttpServer::renderMetrics() const {
+    std::string out;
+    Metrics::registry().render(out);
+    const MemoryGovernor& governor = executor_.memoryGovernor();
+    Metrics::renderGauge(out, "db_memory_used_bytes", "Memory reserved by running queries",
+                         static_cast<double>(governor.used()));
+    Metrics::renderGauge(out, "db_memory_limit_bytes", "Memory limit for all queries",
+                         static_cast<double>(governor.limit()));
+    Metrics::renderGauge(out, "db_open_cursors", "Open server-side cursors", static_cast<double>(cursors_.size()));
+    Metrics::renderGauge(out, "db_execution_queue_length", "Admitted queries waiting for an execution thread",
+                         static_cast<double>(execution_.queued()));
+
+    const auto lanes = admission_.stats();
+    const auto& classes = admission_.classes();
+    Metrics::renderGaugeHeader(out, "db_admission_running", "Queries running per workload class");
+    for (size_t i = 0; i < lanes.size(); ++i) {
+        Metrics::renderSample(out, "db_admission_running", {"class"}, {classes[i].name},
+                              static_cast<double>(lanes[i].running));
+    }
+    Metrics::renderGaugeHeader(out, "db_admission_queued", "Queries waiting for admission per workload class");
+    for (size_t i = 0; i < lanes.size(); ++i) {
+        Metrics::renderSample(out, "db_admission_queued", {"class"}, {classes[i].name},
+                              static_cast<double>(lanes[i].queued));
+    }
+    return out;
+}
+
+void HttpServer::submit(std::shared_ptr<HttpExchange> exchange, Handler handler) {
+    const std::string& class_name = exchange->request().header("x-workload-class");
+    const auto workload = admission_.classIndex(class_name);
+    if (!workload) {
+        return exchange->response().send(400, kJson,
+                                         JsonHandler::serializeError("Unknown workload class: " + class_name));
+    }
+    auto run = [this, exchange, handler] {
+        try {
+            (this->*handler)(exchange->request(), exchange->response());
+        } catch (const asio::system_error&) {
+            // Клиент ушёл посреди ответа; соединение закроет HttpExchange
+        }
+    };
+    auto reject = [exchange](const std::string& reason) {
+        HttpResponseWriter& res = exchange->response();
+        res.setHeader("Retry-After", "1");
+        try {
+            res.send(503, kJson, JsonHandler::serializeError(reason));
+        } catch (const asio::system_error&) {
+        }
+    };
+    admission_.submit(*workload, std::move(run), std::move(reject));
+}
+
+std::shared_ptr<QueryContext> HttpServer::startQuery(const HttpRequest& req, HttpResponseWriter& res,
+                                                     std::string& sql) {
+    // Тело — SQL-текст или, с Content-Type: application/json, {"query": "..."}
+    sql = req.body;
+    if (req.header("content-type").rfind(kJson, 0) == 0) {
+        auto query = JsonHandler::parseQueryRequest(req.body);
+        if (!query) {
+            res.send(400, kJson, JsonHandler::serializeError("Expected {\"query\": \"...\"}"));
+            return nullptr;
+        }
+        sql = std::move(*query);
+    }
+    if (sql.empty()) {
+        res.send(400, kJson, JsonHandler::serializeError("Query cannot be empty."));
+        return nullptr;
+    }
+    std::chrono::milliseconds timeout;
+    if (!statementTimeout(req, res, timeout)) return nullptr;
+
+    // Свой X-Query-Id позволяет отменить запрос, ещё не получив ни байта ответа
+    std::shared_ptr<QueryContext> ctx;
+    try {
+        ctx = executor_.createContext(req.header("x-query-id"), 0, timeout);
+    } catch (const std::invalid_argument& e) {
+        res.send(409, kJson, JsonHandler::serializeError(e.what()));
+        return nullptr;
+    }
+    if (slow_log_) ctx->enableProfile();
+    res.setHeader("X-Query-Id", ctx->queryId());
+    return ctx;
+}
 
-    std::cout << "Starting server on port 18080..." << std::endl;
-    app.port(18080).multithreaded().run();
-}
\ No newline at end of file
+bool HttpServer::statementTimeout(const HttpRequest& req, HttpResponseWriter& res,
+                                  std::chrono::milliseconds& timeout) {
+    // Без заголовка — срок из конфига исполнителя
+    timeout = std::chrono::milliseconds(0);
+    const std::string& header = req.header("x-statement-timeout-ms");
+    if (header.empty()) return true;
+    auto parsed = parseCount(header);
+    if (!parsed) {
+        res.send(400, kJson, JsonHandler::serializeError("Bad X-Statement-Timeout-Ms: " + header));
+        return false;
+    }
+    timeout = std::chrono::milliseconds(*parsed);
+    return true;
+}
+
+void HttpServer::handleQuery(const HttpRequest& req, HttpResponseWriter& res) {
+    std::string sql;
+    std::shared_ptr<QueryContext> ctx;
+    uint64_t rows = 0;
+    try {
+        ctx = startQuery(req, res, sql);
+        if (!ctx) return;
+        StatementResult result = engine_.execute(sql, ctx);
+        if (!result.rows) {
+            rows = result.affected_rows;
+            res.send(200, kJson, JsonHandler::serializeStatementResult(result.message, result.affected_rows));
+        } else {
+            auto encoder = makeResultEncoder(req.header("accept"), result.columns, result.column_types);
+            res.setHeader("Vary", "Accept, Accept-Encoding");
+            rows = streamRows(result, *encoder, res, responseEncoding(req), ctx->profile());
+        }
+    } catch (const asio::system_error& e) {
+        logSlowQuery(sql, ctx.get(), rows,
+                     e.code() == asio::error::timed_out ? "client stopped reading" : "client disconnected");
+        throw;
+    } catch (const std::exception& e) {
+        logSlowQuery(sql, ctx.get(), rows, e.what());
+        // После начала потока статус уже не поменять — соединение просто рвётся
+        if (res.headersSent()) throw;
+        return res.send(errorStatus(e), kJson, JsonHandler::serializeError(e.what()));
+    }
+    logSlowQuery(sql, ctx.get(), rows, "");
+}
+
+void HttpServer::handleOpenCursor(const HttpRequest& req, HttpResponseWriter& res) {
+    try {
+        std::string sql;
+        auto ctx = startQuery(req, res, sql);
+        if (!ctx) return;
+        StatementResult result = engine_.execute(sql, ctx);
+        // Не SELECT: курсор не нужен, ответ как у /api/query
+        if (!result.rows) {
+            return res.send(200, kJson, JsonHandler::serializeStatementResult(result.message, result.affected_rows));
+        }
+        auto cursor = std::make_shared<Cursor>(std::move(result), ctx);
+        const std::vector<std::string> columns = cursor->result.columns;
+        if (!cursors_.open(std::move(cursor))) {
+            res.setHeader("Retry-After", "1");
+            return res.send(503, kJson, JsonHandler::serializeError("Too many open cursors"));
+        }
+        res.send(200, kJson, JsonHandler::serializeCursor(ctx->queryId(), columns));
+    } catch (const asio::system_error&) {
+        throw;
+    } catch (const std::exception& e) {
+        res.send(errorStatus(e), kJson, JsonHandler::serializeError(e.what()));
+    }
+}
+
+void HttpServer::handleFetchCursor(const HttpRequest& req, HttpResponseWriter& res) {
+    static Metrics::Histogram& execute_time = queryPhaseHistogram("execute");
+    static Metrics::Histogram& serialize_time = queryPhaseHistogram("serialize");
+    const std::string cursor_id = req.path.substr(std::string_view(kCursorPrefix).size());
+    size_t rows = config_.cursor_fetch_rows;
+    if (const std::string param = req.queryParam("rows"); !param.empty()) {
+        auto parsed = parseCount(param);
+        if (!parsed || *parsed == 0) return res.send(400, kJson, JsonHandler::serializeError("Bad rows: " + param));
+        rows = std::min<size_t>(*parsed, config_.max_cursor_fetch_rows);
+    }
+    std::chrono::milliseconds timeout;
+    if (!statementTimeout(req, res, timeout)) return;
+    if (timeout.count() == 0) timeout = executor_.config().statement_timeout;
+
+    auto cursor = cursors_.find(cursor_id);
+    if (!cursor) return res.send(404, kJson, JsonHandler::serializeError("No open cursor " + cursor_id));
+    std::unique_lock<std::mutex> lock(cursor->mutex, std::try_to_lock);
+    if (!lock) return res.send(409, kJson, JsonHandler::serializeError("Cursor " + cursor_id + " is busy"));
+
+    StatementResult& result = cursor->result;
+    auto encoder = makeResultEncoder(req.header("accept"), result.columns, result.column_types);
+    std::string page;
+    bool done = false;
+    try {
+        // Срок statement timeout — на каждую выборку: между ними курсор стоит
+        if (timeout.count() != 0) cursor->ctx->setDeadline(QueryContext::Clock::now() + timeout);
+        encoder->begin(page);
+        size_t fetched = 0;
+        if (cursor->has_pending) {
+            encoder->add(page, std::move(cursor->pending));
+            cursor->has_pending = false;
+            ++fetched;
+        }
+        Clock::duration execute{};
+        Clock::duration serialize{};
+        std::vector<Row> batch;
+        bool more = true;
+        while (more && fetched < rows) {
+            const auto pull_start = Clock::now();
+            more = pullRows(*result.rows, batch, std::min(kTimedBatchRows, rows - fetched));
+            const auto encode_start = Clock::now();
+            for (Row& row : batch) encoder->add(page, std::move(row));
+            fetched += batch.size();
+            execute += encode_start - pull_start;
+            serialize += Clock::now() - encode_start;
+        }
+        cursor->has_pending = more && result.rows->next(cursor->pending);
+        done = !cursor->has_pending;
+        encoder->finish(page);
+        execute_time.record(execute);
+        serialize_time.record(serialize);
+    } catch (const std::exception& e) {
+        lock.unlock();
+        cursors_.close(cursor_id);
+        return res.send(errorStatus(e), kJson, JsonHandler::serializeError(e.what()));
+    }
+    lock.unlock();
+    // Последняя страница закрывает курсор: память запроса отпускается сразу
+    if (done) cursors_.close(cursor_id);
+    res.setHeader("Vary", "Accept, Accept-Encoding");
+    res.setHeader("X-Cursor-Done", done ? "true" : "false");
+    sendBody(res, encoder->contentType(), page, responseEncoding(req));
+}
+
+ContentEncoding HttpServer::responseEncoding(const HttpRequest& req) const {
+    return config_.compression ? negotiateEncoding(req.header("accept-encoding")) : ContentEncoding::Identity;
+}
+
+uint64_t HttpServer::streamRows(StatementResult& result, ResultEncoder& encoder, HttpResponseWriter& res,
+                                ContentEncoding encoding, QueryProfile* profile) {
+    static Metrics::Histogram& execute_time = queryPhaseHistogram("execute");
+    static Metrics::Histogram& serialize_time = queryPhaseHistogram("serialize");
+    // Сериализация — кодирование и сжатие; запись в сокет не считается ни туда, ни сюда
+    Clock::duration execute{};
+    Clock::duration serialize{};
+    Clock::duration sending{};
+
+    std::unique_ptr<StreamCompressor> compressor;
+    std::string chunk;
+    std::string compressed;
+    auto send_chunk = [&](std::string_view data) {
+        const auto start = Clock::now();
+        res.writeChunk(data);
+        sending += Clock::now() - start;
+    };
+    auto write_chunk = [&] {
+        if (!compressor) return send_chunk(chunk);
+        compressed.clear();
+        compressor->write(chunk, compressed);
+        send_chunk(compressed);
+    };
+
+    Clock::time_point last_flush;
+    auto flush = [&] {
+        if (!res.headersSent()) {
+            compressor = makeCompressor(encoding, config_.compression_level);
+            if (compressor) res.setHeader("Content-Encoding", encodingName(encoding));
+            res.beginChunked(200, encoder.contentType());
+        }
+        write_chunk();
+        chunk.clear();
+        last_flush = Clock::now();
+    };
+
+    encoder.begin(chunk);
+    std::vector<Row> batch;
+    batch.reserve(kTimedBatchRows);
+    uint64_t rows = 0;
+    bool more = true;
+    while (more) {
+        const auto pull_start = Clock::now();
+        more = pullRows(*result.rows, batch, kTimedBatchRows);
+        rows += batch.size();
+        const auto encode_start = Clock::now();
+        execute += encode_start - pull_start;
+        const Clock::duration sent_before = sending;
+        for (Row& row : batch) {
+            encoder.add(chunk, std::move(row));
+            if (chunk.size() >= kStreamChunkBytes) flush();
+        }
+        // Результат не уместился в одну пачку — он не маленький, и клиент получает
+        // первые строки сразу, а не после 64 KB
+        if (more && !chunk.empty() && (!res.headersSent() || Clock::now() - last_flush >= kStreamFlushInterval)) {
+            flush();
+        }
+        serialize += Clock::now() - encode_start - (sending - sent_before);
+    }
+    encoder.finish(chunk);
+    execute_time.record(execute);
+    serialize_time.record(serialize);
+    if (profile) {
+        profile->addPhase(QueryProfile::Phase::Execute, execute);
+        profile->addPhase(QueryProfile::Phase::Serialize, serialize);
+    }
+    // Маленький результат уходит одним ответом с Content-Length
+    if (!res.headersSent()) {
+        sendBody(res, encoder.contentType(), chunk, encoding);
+        return rows;
+    }
+    write_chunk();
+    if (compressor) {
+        compressed.clear();
+        compressor->finish(compressed);
+        res.writeChunk(compressed);
+    }
+    res.endChunked();
+    return rows;
+}
+
+void HttpServer::logSlowQuery(const std::string& sql, const QueryContext* ctx, uint64_t rows,
+                              const std::string& error) {
+    if (slow_log_ && ctx) slow_log_->record(sql, *ctx, rows, error);
+}
+
+void HttpServer::sendBody(HttpResponseWriter& res, std::string_view content_type, const std::string& body,
+                          ContentEncoding encoding) {
+    auto compressor = body.size() >= config_.min_compress_bytes
+                          ? makeCompressor(encoding, config_.compression_level)
+                          : nullptr;
+    if (!compressor) return res.send(200, content_type, body);
+    std::string compressed;
+    compressor->write(body, compressed);
+    compressor->finish(compressed);
+    res.setHeader("Content-Encoding", encodingName(encoding));
+    res.send(200, content_type, compressed);
+}
@@ -1,21 +1,89 @@
 #include "api/json_handler.h"
+#include "api/json_writer.h"
 #include <string>
 #include "nlohmann/json.hpp"
 
 namespace JsonHandler {
     using json = nlohmann::json;
 
+    namespace {
+        // Без отступов; в сообщениях бывает текст запроса, и невалидный UTF-8 не должен ронять ответ
+        std::string dump(const json& j) {
+            return j.dump(-1, ' ', false, json::error_handler_t::replace);
+        }
+    }
+
+    std::optional<std::string> parseQueryRequest(const std::string& body) {
+        const json j = json::parse(body, nullptr, false);
+        if (j.is_discarded() || !j.is_object()) return std::nullopt;
+        auto it = j.find("query");
+        if (it == j.end() || !it->is_string()) return std::nullopt;
+        return it->get<std::string>();
+    }
+
     std::string serializeSuccess(const std::string& message) {
         json j;
         j["status"] = "success";
         j["data"]["message"] = message;
-        return j.dump(4);
+        return dump(j);
     }
 
     std::string serializeError(const std::string& error_message) {
         json j;
         j["status"] = "error";
         j["error"] = error_message;
-        return j.dump(4);
+        return dump(j);
+    }
+
+    std::string serializeStatementResult(const std::string& message, size_t affected_rows) {
+        json j;
+        j["status"] = "success";
+        j["data"]["message"] = message;
+        j["data"]["affected_rows"] = affected_rows;
+        return dump(j);
+    }
+
+    std::string serializeResultHeader(const std::vector<std::string>& columns) {
+        std::string out = R"({"status":"success","data":{"columns":[)";
+        JsonWriter writer(out);
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (i != 0) writer.raw(",");
+            writer.string(columns[i]);
+        }
+        writer.raw(R"(],"rows":[)");
+        return out;
+    }
+
+    void appendRow(std::string& out, const Row& row) {
+        JsonWriter(out).row(row);
+    }
+
+    std::string serializeResultFooter() {
+        return "]}}";
+    }
+
+    std::string serializeCursor(const std::string& cursor_id, const std::vector<std::string>& columns) {
+        json j;
+        j["status"] = "success";
+        j["data"]["cursor"] = cursor_id;
+        j["data"]["columns"] = columns;
+        return dump(j);
+    }
+
+    std::string serializeMemoryUsage(const std::vector<QueryMemoryUsage>& queries, size_t used, size_t limit) {
+        json j;
+        j["status"] = "success";
+        j["data"]["used_bytes"] = used;
+        j["data"]["limit_bytes"] = limit;
+        j["data"]["queries"] = json::array();
+        for (const auto& q : queries) {
+            j["data"]["queries"].push_back({
+                {"query_id", q.query_id},
+                {"used_bytes", q.used},
+                {"peak_bytes", q.peak},
+                {"limit_bytes", q.limit}
+            });
+        }
+        return dump(j);
     }
 }
\ No newline at end of file
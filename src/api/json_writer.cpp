@@ -0,0 +1,112 @@
+#include "api/json_writer.h"
+#include <charconv>
+#include <cmath>
+
+namespace {
+    constexpr char kHex[] = "0123456789abcdef";
+    constexpr std::string_view kReplacement = "\xEF\xBF\xBD";
+
+    // Длина корректной UTF-8 последовательности в начале s, 0 — некорректна
+    size_t utf8SequenceLength(std::string_view s) {
+        const auto b0 = static_cast<unsigned char>(s[0]);
+        size_t len;
+        uint32_t min;
+        if (b0 >= 0xC2 && b0 <= 0xDF) {
+            len = 2;
+            min = 0x80;
+        } else if (b0 >= 0xE0 && b0 <= 0xEF) {
+            len = 3;
+            min = 0x800;
+        } else if (b0 >= 0xF0 && b0 <= 0xF4) {
+            len = 4;
+            min = 0x10000;
+        } else {
+            return 0;
+        }
+        if (s.size() < len) return 0;
+        uint32_t cp = b0 & (0x7F >> len);
+        for (size_t i = 1; i < len; ++i) {
+            const auto b = static_cast<unsigned char>(s[i]);
+            if ((b & 0xC0) != 0x80) return 0;
+            cp = (cp << 6) | (b & 0x3F);
+        }
+        // Overlong-формы, суррогаты и всё выше U+10FFFF
+        if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return 0;
+        return len;
+    }
+}
+
+void JsonWriter::string(std::string_view s) {
+    out_ += '"';
+    size_t run = 0; // начало ещё не скопированного куска без экранирования
+    size_t i = 0;
+    while (i < s.size()) {
+        const auto c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\' && c < 0x80) {
+            ++i;
+            continue;
+        }
+        if (c >= 0x80) {
+            const size_t len = utf8SequenceLength(s.substr(i));
+            if (len != 0) {
+                i += len;
+                continue;
+            }
+        }
+        out_.append(s.data() + run, i - run);
+        switch (c) {
+            case '"': out_ += "\\\""; break;
+            case '\\': out_ += "\\\\"; break;
+            case '\n': out_ += "\\n"; break;
+            case '\r': out_ += "\\r"; break;
+            case '\t': out_ += "\\t"; break;
+            case '\b': out_ += "\\b"; break;
+            case '\f': out_ += "\\f"; break;
+            default:
+                if (c < 0x20) {
+                    const char escaped[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+                    out_.append(escaped, sizeof(escaped));
+                } else {
+                    out_ += kReplacement;
+                }
+        }
+        run = ++i;
+    }
+    out_.append(s.data() + run, s.size() - run);
+    out_ += '"';
+}
+
+void JsonWriter::integer(int64_t v) {
+    char buf[24];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), v);
+    out_.append(buf, result.ptr);
+}
+
+void JsonWriter::number(double v) {
+    if (!std::isfinite(v)) return null();
+    char buf[32];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), v);
+    out_.append(buf, result.ptr);
+    // 2.0, а не 2: клиент должен видеть, что колонка дробная
+    if (std::string_view(buf, static_cast<size_t>(result.ptr - buf)).find_first_of(".e") == std::string_view::npos) {
+        out_ += ".0";
+    }
+}
+
+void JsonWriter::value(const Value& v) {
+    switch (v.index()) {
+        case 1: return integer(std::get<int64_t>(v));
+        case 2: return number(std::get<double>(v));
+        case 3: return string(std::get<std::string>(v));
+        default: return null();
+    }
+}
+
+void JsonWriter::row(const Row& row) {
+    out_ += '[';
+    for (size_t i = 0; i < row.size(); ++i) {
+        if (i != 0) out_ += ',';
+        value(row[i]);
+    }
+    out_ += ']';
+}
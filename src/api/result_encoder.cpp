@@ -0,0 +1,166 @@
+#include "api/result_encoder.h"
+#include "api/json_handler.h"
+#include <cstring>
+
+namespace {
+    constexpr const char* kJsonContentType = "application/json";
+    // Пачка колоночного формата: не больше стольких строк или байт
+    constexpr size_t kColumnarBatchRows = 4096;
+    constexpr size_t kColumnarBatchBytes = 16 << 20;
+
+    class JsonResultEncoder : public ResultEncoder {
+    public:
+        explicit JsonResultEncoder(std::vector<std::string> columns) : columns_(std::move(columns)) {}
+
+        const char* contentType() const override { return kJsonContentType; }
+
+        void begin(std::string& out) override { out += JsonHandler::serializeResultHeader(columns_); }
+
+        void add(std::string& out, Row row) override {
+            if (!first_) out += ',';
+            first_ = false;
+            JsonHandler::appendRow(out, row);
+        }
+
+        void finish(std::string& out) override { out += JsonHandler::serializeResultFooter(); }
+
+    private:
+        std::vector<std::string> columns_;
+        bool first_ = true;
+    };
+
+    void putU8(std::string& out, uint8_t v) { out += static_cast<char>(v); }
+
+    void putU16(std::string& out, uint16_t v) {
+        const char bytes[] = {static_cast<char>(v), static_cast<char>(v >> 8)};
+        out.append(bytes, sizeof(bytes));
+    }
+
+    void putU32(std::string& out, uint32_t v) {
+        const char bytes[] = {static_cast<char>(v), static_cast<char>(v >> 8), static_cast<char>(v >> 16),
+                              static_cast<char>(v >> 24)};
+        out.append(bytes, sizeof(bytes));
+    }
+
+    void putU64(std::string& out, uint64_t v) {
+        putU32(out, static_cast<uint32_t>(v));
+        putU32(out, static_cast<uint32_t>(v >> 32));
+    }
+
+    // Строки копятся в пачку и транспонируются в колонки целиком
+    class ColumnarResultEncoder : public ResultEncoder {
+    public:
+        ColumnarResultEncoder(std::vector<std::string> columns, std::vector<ColumnType> types)
+            : columns_(std::move(columns)), types_(std::move(types)) {
+            batch_.reserve(kColumnarBatchRows);
+        }
+
+        const char* contentType() const override { return kColumnarContentType; }
+
+        void begin(std::string& out) override {
+            out += "SRCB";
+            putU16(out, 1);
+            putU32(out, static_cast<uint32_t>(columns_.size()));
+            for (size_t i = 0; i < columns_.size(); ++i) {
+                putU8(out, columnTypeCode(types_[i]));
+                putU32(out, static_cast<uint32_t>(columns_[i].size()));
+                out += columns_[i];
+            }
+        }
+
+        void add(std::string& out, Row row) override {
+            batch_bytes_ += estimateRowBytes(row);
+            batch_.push_back(std::move(row));
+            if (batch_.size() == kColumnarBatchRows || batch_bytes_ >= kColumnarBatchBytes) flush(out);
+        }
+
+        void finish(std::string& out) override {
+            flush(out);
+            putU32(out, 0);
+        }
+
+    private:
+        void flush(std::string& out) {
+            if (batch_.empty()) return;
+            const size_t n = batch_.size();
+            putU32(out, static_cast<uint32_t>(n));
+            for (size_t c = 0; c < columns_.size(); ++c) {
+                writeValidity(out, c);
+                switch (types_[c]) {
+                    case ColumnType::Int64:
+                        for (const Row& row : batch_) {
+                            const Value& v = row[c];
+                            putU64(out, std::holds_alternative<int64_t>(v) ? static_cast<uint64_t>(std::get<int64_t>(v)) : 0);
+                        }
+                        break;
+                    case ColumnType::Double:
+                        for (const Row& row : batch_) {
+                            const double d = isNumeric(row[c]) ? toDouble(row[c]) : 0.0;
+                            uint64_t bits;
+                            std::memcpy(&bits, &d, sizeof(bits));
+                            putU64(out, bits);
+                        }
+                        break;
+                    case ColumnType::String: {
+                        uint32_t offset = 0;
+                        putU32(out, 0);
+                        for (const Row& row : batch_) {
+                            if (const auto* s = std::get_if<std::string>(&row[c])) offset += static_cast<uint32_t>(s->size());
+                            putU32(out, offset);
+                        }
+                        for (const Row& row : batch_) {
+                            if (const auto* s = std::get_if<std::string>(&row[c])) out += *s;
+                        }
+                        break;
+                    }
+                }
+            }
+            batch_.clear();
+            batch_bytes_ = 0;
+        }
+
+        // Значение есть, только если его тип совпадает с типом колонки
+        bool present(const Value& v, ColumnType type) const {
+            switch (type) {
+                case ColumnType::Int64: return std::holds_alternative<int64_t>(v);
+                case ColumnType::Double: return isNumeric(v);
+                case ColumnType::String: return std::holds_alternative<std::string>(v);
+            }
+            return false;
+        }
+
+        void writeValidity(std::string& out, size_t column) {
+            uint8_t byte = 0;
+            for (size_t i = 0; i < batch_.size(); ++i) {
+                if (present(batch_[i][column], types_[column])) byte |= static_cast<uint8_t>(1u << (i % 8));
+                if (i % 8 == 7) {
+                    putU8(out, byte);
+                    byte = 0;
+                }
+            }
+            if (batch_.size() % 8 != 0) putU8(out, byte);
+        }
+
+        std::vector<std::string> columns_;
+        std::vector<ColumnType> types_;
+        std::vector<Row> batch_;
+        size_t batch_bytes_ = 0;
+    };
+}
+
+uint8_t columnTypeCode(ColumnType type) {
+    switch (type) {
+        case ColumnType::Int64: return 0;
+        case ColumnType::Double: return 1;
+        case ColumnType::String: return 2;
+    }
+    return 2;
+}
+
+std::unique_ptr<ResultEncoder> makeResultEncoder(const std::string& accept, std::vector<std::string> columns,
+                                                 std::vector<ColumnType> types) {
+    if (accept.find(kColumnarContentType) != std::string::npos) {
+        return std::make_unique<ColumnarResultEncoder>(std::move(columns), std::move(types));
+    }
+    return std::make_unique<JsonResultEncoder>(std::move(columns));
+}
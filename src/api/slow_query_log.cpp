@@ -0,0 +1,107 @@
+#include "api/slow_query_log.h"
+#include "common/metrics.h"
+#include "query_engine/lexer.h"
+#include <charconv>
+#include <ctime>
+
+namespace {
+    constexpr const char* kPhaseNames[QueryProfile::kPhases] = {"parse", "optimize", "execute", "serialize"};
+
+    void appendSeconds(std::string& out, std::chrono::nanoseconds time) {
+        char buf[32];
+        const auto result = std::to_chars(buf, buf + sizeof(buf), static_cast<double>(time.count()) / 1e9,
+                                          std::chars_format::fixed, 6);
+        out.append(buf, result.ptr);
+        out += " s";
+    }
+
+    // 2026-01-31T12:34:56.789Z
+    void appendTimestamp(std::string& out, std::chrono::system_clock::time_point now) {
+        const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+        const auto millis =
+            std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+        std::tm tm{};
+        gmtime_r(&seconds, &tm);
+        char buf[32];
+        const size_t n = std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+        out.append(buf, n);
+        out += '.';
+        out += static_cast<char>('0' + millis / 100);
+        out += static_cast<char>('0' + millis / 10 % 10);
+        out += static_cast<char>('0' + millis % 10);
+        out += 'Z';
+    }
+
+    Metrics::Counter& slowQueries() {
+        static auto& counter =
+            Metrics::registry().counter("db_slow_queries_total", "Queries slower than the threshold").with({});
+        return counter;
+    }
+
+    Metrics::Counter& droppedEntries() {
+        static auto& counter = Metrics::registry()
+                                   .counter("db_slow_query_log_dropped_total",
+                                            "Slow query log entries dropped because the log queue was full")
+                                   .with({});
+        return counter;
+    }
+
+    // Строка комментария: переводы строк в тексте ошибки не должны ломать запись
+    void appendLine(std::string& out, const std::string& text) {
+        for (char c : text) out += c == '\n' || c == '\r' ? ' ' : c;
+    }
+}
+
+SlowQueryLog::SlowQueryLog(const std::string& path, std::chrono::milliseconds threshold)
+    : threshold_(threshold), log_(path) {
+    // Счётчики видны в /metrics с нулём, а не с первой записи
+    slowQueries();
+    droppedEntries();
+}
+
+void SlowQueryLog::record(const std::string& sql, const QueryContext& ctx, uint64_t rows,
+                          const std::string& error) {
+    const auto duration = QueryContext::Clock::now() - ctx.started();
+    if (duration < threshold_) return;
+    slowQueries().inc();
+
+    // Формат как у журнала медленных запросов MySQL: комментарии # и сам запрос
+    std::string entry = "# Time: ";
+    appendTimestamp(entry, std::chrono::system_clock::now());
+    entry += "\n# Query_id: ";
+    appendLine(entry, ctx.queryId());
+    entry += "  Duration: ";
+    appendSeconds(entry, duration);
+    entry += "  Rows: " + std::to_string(rows);
+    entry += "\n# Status: ";
+    if (error.empty()) {
+        entry += "ok";
+    } else {
+        entry += "error: ";
+        appendLine(entry, error);
+    }
+    if (const QueryProfile* profile = ctx.profile()) {
+        entry += "\n# Lock_wait: ";
+        appendSeconds(entry, profile->lockWait());
+        entry += "\n# Phases:";
+        for (size_t i = 0; i < QueryProfile::kPhases; ++i) {
+            entry += i == 0 ? " " : ", ";
+            entry += kPhaseNames[i];
+            entry += ' ';
+            appendSeconds(entry, profile->phase(static_cast<QueryProfile::Phase>(i)));
+        }
+        if (!profile->operators().empty()) entry += "\n# Plan:";
+        for (const QueryProfile::Operator& op : profile->operators()) {
+            entry += "\n#   ";
+            entry.append(op.depth * 2, ' ');
+            entry += op.name;
+            entry += "  rows=" + std::to_string(op.rows) + " time=";
+            appendSeconds(entry, op.elapsed());
+        }
+    }
+    entry += '\n';
+    entry += normalizeQuery(sql);
+    if (entry.back() != ';') entry += ';';
+    entry += '\n';
+    if (!log_.write(std::move(entry))) droppedEntries().inc();
+}
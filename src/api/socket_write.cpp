@@ -0,0 +1,60 @@
+#include "api/socket_write.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace {
+    // Исполняет ли текущий поток обработчик executor'а сокета
+    bool runningInThisThread(const asio::any_io_executor& executor) {
+        using IoExecutor = asio::io_context::executor_type;
+        if (auto* strand = executor.target<asio::strand<IoExecutor>>()) return strand->running_in_this_thread();
+        if (auto* io = executor.target<IoExecutor>()) return io->running_in_this_thread();
+        return false;
+    }
+}
+
+void writeWithDeadline(asio::ip::tcp::socket& socket, const std::vector<asio::const_buffer>& buffers,
+                       std::chrono::seconds timeout) {
+    // На потоке самого io_context ждать асинхронную запись нельзя — её некому
+    // исполнить. Там пишутся только короткие ответы, им хватает блокирующей записи
+    if (timeout.count() == 0 || runningInThisThread(socket.get_executor())) {
+        asio::write(socket, buffers);
+        return;
+    }
+
+    struct State {
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool done = false;
+        asio::error_code error;
+        bool timed_out = false; // только на strand
+        bool written = false;   // только на strand
+    };
+    auto state = std::make_shared<State>();
+    // Таймер и шаги записи идут через один strand: отмена не гоняется с записью
+    auto strand = asio::make_strand(socket.get_executor());
+    auto timer = std::make_shared<asio::steady_timer>(strand, timeout);
+
+    asio::post(strand, [&socket, &buffers, strand, timer, state] {
+        timer->async_wait(asio::bind_executor(strand, [&socket, state](const asio::error_code& ec) {
+            // Запись могла закончиться, пока срабатывание ждало очереди
+            if (ec || state->written) return;
+            state->timed_out = true;
+            asio::error_code ignored;
+            socket.cancel(ignored);
+        }));
+        asio::async_write(socket, buffers,
+                          asio::bind_executor(strand, [timer, state](const asio::error_code& ec, size_t) {
+                              state->written = true;
+                              timer->cancel();
+                              std::lock_guard<std::mutex> lock(state->mutex);
+                              state->error = state->timed_out ? asio::error::timed_out : ec;
+                              state->done = true;
+                              state->changed.notify_one();
+                          }));
+    });
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->changed.wait(lock, [&] { return state->done; });
+    if (state->error) throw asio::system_error(state->error);
+}
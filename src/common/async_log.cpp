@@ -0,0 +1,81 @@
+#include "common/async_log.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    // Пустую очередь писатель проверяет с таким интервалом: записи редкие,
+    // а будить его из write значило бы брать мьютекс на пишущем потоке
+    constexpr auto kIdlePoll = std::chrono::milliseconds(20);
+
+    size_t roundUpPow2(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+}
+
+AsyncLog::AsyncLog(const std::string& path, size_t capacity)
+    : slots_(new Slot[roundUpPow2(capacity)]), mask_(roundUpPow2(capacity) - 1),
+      file_(std::fopen(path.c_str(), "a")) {
+    if (!file_) throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    for (size_t i = 0; i <= mask_; ++i) slots_[i].sequence.store(i, std::memory_order_relaxed);
+    writer_ = std::thread([this] { writeLoop(); });
+}
+
+AsyncLog::~AsyncLog() {
+    stopping_.store(true, std::memory_order_release);
+    writer_.join();
+    std::fclose(file_);
+}
+
+bool AsyncLog::write(std::string entry) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots_[pos & mask_];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.entry = std::move(entry);
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // Ячейку ещё не разобрал писатель: очередь полна
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool AsyncLog::pop(std::string& entry) {
+    // Читатель один — поток writer_, поэтому позиция без CAS
+    const size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[pos & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1) return false;
+    entry = std::move(slot.entry);
+    slot.entry.clear();
+    dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+    slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+void AsyncLog::writeLoop() {
+    std::string entry;
+    for (;;) {
+        // Флаг читается до разбора: всё, что записано до деструктора, будет дописано
+        const bool stopping = stopping_.load(std::memory_order_acquire);
+        bool wrote = false;
+        while (pop(entry)) {
+            std::fwrite(entry.data(), 1, entry.size(), file_);
+            wrote = true;
+        }
+        if (wrote) std::fflush(file_);
+        if (stopping) return;
+        if (!wrote) std::this_thread::sleep_for(kIdlePoll);
+    }
+}
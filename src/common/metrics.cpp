@@ -0,0 +1,235 @@
+#include "common/metrics.h"
+#include <charconv>
+#include <cmath>
+
+namespace Metrics {
+    namespace {
+        // Границы le экспортируемых гистограмм: 2^3..2^25 мкс (8 мкс .. ~33 с).
+        // Это границы корзин, поэтому счёт по ним точный.
+        constexpr unsigned kFirstLeShift = 3;
+        constexpr unsigned kLastLeShift = 25;
+
+        constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+        void appendNumber(std::string& out, double value) {
+            char buf[32];
+            const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+            out.append(buf, result.ptr);
+        }
+
+        void appendNumber(std::string& out, uint64_t value) {
+            char buf[24];
+            const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+            out.append(buf, result.ptr);
+        }
+
+        void appendLabelValue(std::string& out, const std::string& value) {
+            for (char c : value) {
+                if (c == '\\' || c == '"') {
+                    out += '\\';
+                    out += c;
+                } else if (c == '\n') {
+                    out += "\\n";
+                } else {
+                    out += c;
+                }
+            }
+        }
+
+        // {a="x",b="y"} с дополнительной меткой extra (например le), если она есть
+        void appendLabels(std::string& out, const std::vector<std::string>& names,
+                          const std::vector<std::string>& values, std::string_view extra_name = {},
+                          std::string_view extra_value = {}) {
+            if (names.empty() && extra_name.empty()) return;
+            out += '{';
+            for (size_t i = 0; i < names.size(); ++i) {
+                if (i != 0) out += ',';
+                out += names[i];
+                out += "=\"";
+                appendLabelValue(out, values[i]);
+                out += '"';
+            }
+            if (!extra_name.empty()) {
+                if (!names.empty()) out += ',';
+                out.append(extra_name);
+                out += "=\"";
+                out.append(extra_value);
+                out += '"';
+            }
+            out += '}';
+        }
+
+        void appendHeader(std::string& out, const std::string& name, const std::string& help, const char* type) {
+            out += "# HELP " + name + " " + help + "\n";
+            out += "# TYPE " + name + " " + type + "\n";
+        }
+
+        std::string seconds(uint64_t micros) {
+            std::string s;
+            appendNumber(s, static_cast<double>(micros) / 1e6);
+            return s;
+        }
+    }
+
+    size_t shardIndex() {
+        static std::atomic<size_t> next{0};
+        thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+        return index;
+    }
+
+    uint64_t Counter::value() const {
+        uint64_t total = 0;
+        for (const Shard& shard : shards_) total += shard.value.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    Histogram::Histogram() : shards_(new Shard[kShards]) {}
+
+    size_t Histogram::bucketIndex(uint64_t micros) {
+        if (micros < kSubBuckets) return static_cast<size_t>(micros);
+        const unsigned octave = 63 - static_cast<unsigned>(__builtin_clzll(micros)); // floor(log2)
+        const size_t sub = static_cast<size_t>(micros >> (octave - kSubBits)) & (kSubBuckets - 1);
+        return std::min(kBuckets - 1, (octave - kSubBits + 1) * kSubBuckets + sub);
+    }
+
+    uint64_t Histogram::bucketUpper(size_t index) {
+        if (index < kSubBuckets) return index + 1;
+        const unsigned octave = static_cast<unsigned>(index / kSubBuckets) - 1 + kSubBits;
+        const uint64_t sub = index % kSubBuckets;
+        return (kSubBuckets + sub + 1) << (octave - kSubBits);
+    }
+
+    void Histogram::recordMicros(uint64_t micros) {
+        Shard& shard = shards_[shardIndex()];
+        shard.buckets[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(micros, std::memory_order_relaxed);
+    }
+
+    Histogram::Snapshot Histogram::snapshot() const {
+        Snapshot snap;
+        snap.buckets.assign(kBuckets, 0);
+        for (size_t s = 0; s < kShards; ++s) {
+            const Shard& shard = shards_[s];
+            for (size_t i = 0; i < kBuckets; ++i) snap.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+            snap.sum_micros += shard.sum.load(std::memory_order_relaxed);
+        }
+        // count — по корзинам, а не по отдельному счётчику: шарды читаются не атомарно,
+        // и так счёт гистограммы не расходится с её корзинами
+        for (uint64_t n : snap.buckets) snap.count += n;
+        return snap;
+    }
+
+    uint64_t Histogram::Snapshot::quantileMicros(double q) const {
+        if (count == 0) return 0;
+        const auto rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(count)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen >= std::max<uint64_t>(rank, 1)) return bucketUpper(i);
+        }
+        return bucketUpper(buckets.size() - 1);
+    }
+
+    uint64_t Histogram::Snapshot::countBelow(uint64_t limit) const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < buckets.size() && bucketUpper(i) <= limit; ++i) total += buckets[i];
+        return total;
+    }
+
+    Family<Counter>& Registry::counter(const std::string& name, const std::string& help,
+                                       std::vector<std::string> label_names) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = counters_[name];
+        if (!slot) slot = std::make_unique<Family<Counter>>(name, help, std::move(label_names));
+        return *slot;
+    }
+
+    Family<Histogram>& Registry::histogram(const std::string& name, const std::string& help,
+                                           std::vector<std::string> label_names) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = histograms_[name];
+        if (!slot) slot = std::make_unique<Family<Histogram>>(name, help, std::move(label_names));
+        return *slot;
+    }
+
+    void Registry::render(std::string& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [name, family] : counters_) {
+            appendHeader(out, name, family->help(), "counter");
+            family->forEach([&](const std::vector<std::string>& values, const Counter& counter) {
+                out += name;
+                appendLabels(out, family->labelNames(), values);
+                out += ' ';
+                appendNumber(out, counter.value());
+                out += '\n';
+            });
+        }
+        for (const auto& [name, family] : histograms_) {
+            std::vector<std::pair<std::vector<std::string>, Histogram::Snapshot>> snaps;
+            family->forEach([&](const std::vector<std::string>& values, const Histogram& histogram) {
+                snaps.emplace_back(values, histogram.snapshot());
+            });
+
+            appendHeader(out, name, family->help(), "histogram");
+            for (const auto& [values, snap] : snaps) {
+                for (unsigned shift = kFirstLeShift; shift <= kLastLeShift; ++shift) {
+                    out += name + "_bucket";
+                    appendLabels(out, family->labelNames(), values, "le", seconds(uint64_t{1} << shift));
+                    out += ' ';
+                    appendNumber(out, snap.countBelow(uint64_t{1} << shift));
+                    out += '\n';
+                }
+                out += name + "_bucket";
+                appendLabels(out, family->labelNames(), values, "le", "+Inf");
+                out += ' ';
+                appendNumber(out, snap.count);
+                out += '\n';
+                out += name + "_sum";
+                appendLabels(out, family->labelNames(), values);
+                out += ' ' + seconds(snap.sum_micros) + '\n';
+                out += name + "_count";
+                appendLabels(out, family->labelNames(), values);
+                out += ' ';
+                appendNumber(out, snap.count);
+                out += '\n';
+            }
+
+            // Точные квантили из мелких корзин: по le степеням двойки histogram_quantile грубее
+            const std::string summary = name + "_quantiles";
+            appendHeader(out, summary, family->help() + " (quantiles)", "summary");
+            for (const auto& [values, snap] : snaps) {
+                for (double q : kQuantiles) {
+                    std::string q_text;
+                    appendNumber(q_text, q);
+                    out += summary;
+                    appendLabels(out, family->labelNames(), values, "quantile", q_text);
+                    out += ' ' + seconds(snap.quantileMicros(q)) + '\n';
+                }
+            }
+        }
+    }
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    void renderGauge(std::string& out, const std::string& name, const std::string& help, double value) {
+        renderGaugeHeader(out, name, help);
+        renderSample(out, name, {}, {}, value);
+    }
+
+    void renderGaugeHeader(std::string& out, const std::string& name, const std::string& help) {
+        appendHeader(out, name, help, "gauge");
+    }
+
+    void renderSample(std::string& out, const std::string& name, const std::vector<std::string>& label_names,
+                      const std::vector<std::string>& label_values, double value) {
+        out += name;
+        appendLabels(out, label_names, label_values);
+        out += ' ';
+        appendNumber(out, value);
+        out += '\n';
+    }
+}
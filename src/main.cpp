@@ -1,40 +1,175 @@
-#include <crow.h>
-#include <nlohmann/json.hpp>
+#include "api/http_server.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-using json = nlohmann::json;
+namespace {
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "  --port N                 HTTP port (default 8080)\n"
+                  << "  --binary-port N          binary protocol port, 0 disables (default 0)\n"
+                  << "  --io-threads N           network threads, 0 = hardware threads (default 0)\n"
+                  << "  --worker-threads N       threads for parallel operators, 0 = hardware threads (default 0)\n"
+                  << "  --execution-threads N    threads running queries, 0 = sum of the workload class\n"
+                  << "                           concurrency limits (default 0)\n"
+                  << "  --execution-queue N      queries waiting for a thread before 503 (default 256)\n"
+                  << "  --workload-class NAME:CONCURRENT:QUEUED:TIMEOUT_MS\n"
+                  << "                           admission lane, repeatable; the first one is the default\n"
+                  << "                           (default oltp:8:256:1000 and analytics:2:32:30000)\n"
+                  << "  --cursor-idle-timeout S  seconds before an unused cursor is closed (default 60)\n"
+                  << "  --max-open-cursors N     open cursors before 503 (default 1024)\n"
+                  << "  --slow-query-log PATH    log queries slower than --slow-query-ms to PATH\n"
+                  << "  --slow-query-ms N        slow query threshold (default 1000)\n"
+                  << "  --no-compression         never compress responses\n"
+                  << "  --compression-level N    gzip 1-9 / zstd 1-19, 0 = codec default (default 0)\n"
+                  << "  --min-compress-bytes N   smaller responses are sent uncompressed (default 1024)\n"
+                  << "  --max-body-bytes N       largest accepted request body (default 16777216)\n"
+                  << "  --keep-alive-timeout S   idle seconds before a connection is closed (default 60)\n"
+                  << "  --no-keep-alive          close the connection after every response\n"
+                  << "  --write-timeout S        seconds a client may stall reading a response before\n"
+                  << "                           the query is cancelled, 0 = none (default 30)\n"
+                  << "  --memory-limit BYTES     memory for all queries (default 4 GiB)\n"
+                  << "  --query-memory BYTES     per-query budget before spilling (default 256 MiB)\n"
+                  << "  --statement-timeout-ms N default query timeout, 0 = none (default 0)\n"
+                  << "  --temp-dir PATH          directory for spill files\n";
+    }
 
-int main() {
-    crow::SimpleApp app;
-
-    CROW_ROUTE(app, "/")
-    ([](){
-        return "Database Server is running!";
-    });
+    unsigned long long parseNumber(const std::string& option, const char* text) {
+        char* end = nullptr;
+        const unsigned long long value = std::strtoull(text, &end, 10);
+        if (end == text || *end != '\0' || text[0] == '-') {
+            throw std::invalid_argument("Invalid value for " + option + ": " + text);
+        }
+        return value;
+    }
 
-    CROW_ROUTE(app, "/api/query")
-    .methods(crow::HTTPMethod::Post)
-    ([](const crow::request& req){
-        try {
-            auto body = json::parse(req.body);
-            std::string query = body["query"];
+    unsigned short parsePort(const std::string& option, const char* text) {
+        const unsigned long long port = parseNumber(option, text);
+        if (port > 65535) throw std::invalid_argument("Invalid port for " + option + ": " + text);
+        return static_cast<unsigned short>(port);
+    }
 
-            json response = {
-                {"status", "success"},
-                {"message", "Query received: " + query}
-            };
+    WorkloadClass parseWorkloadClass(const char* text) {
+        const std::string spec = text;
+        std::vector<std::string> parts;
+        size_t start = 0;
+        for (size_t colon; (colon = spec.find(':', start)) != std::string::npos; start = colon + 1) {
+            parts.push_back(spec.substr(start, colon - start));
+        }
+        parts.push_back(spec.substr(start));
+        if (parts.size() != 4 || parts[0].empty()) {
+            throw std::invalid_argument("Expected NAME:CONCURRENT:QUEUED:TIMEOUT_MS, got " + spec);
+        }
+        WorkloadClass workload;
+        workload.name = parts[0];
+        workload.max_concurrent = parseNumber("--workload-class", parts[1].c_str());
+        workload.max_queued = parseNumber("--workload-class", parts[2].c_str());
+        workload.queue_timeout = std::chrono::milliseconds(parseNumber("--workload-class", parts[3].c_str()));
+        if (workload.max_concurrent == 0) throw std::invalid_argument("Workload class " + spec + " admits nothing");
+        return workload;
+    }
 
-            return crow::response(response.dump());
-        } catch (const std::exception& e) {
-            json error = {
-                {"status", "error"},
-                {"message", e.what()}
-            };
-            return crow::response(400, error.dump());
+    ServerConfig parseArgs(int argc, char** argv) {
+        ServerConfig config;
+        bool default_classes = true;
+        for (int i = 1; i < argc; ++i) {
+            const std::string option = argv[i];
+            if (option == "--no-keep-alive") {
+                config.keep_alive = false;
+                continue;
+            }
+            if (option == "--no-compression") {
+                config.compression = false;
+                continue;
+            }
+            if (option == "--help" || option == "-h") {
+                printUsage(argv[0]);
+                std::exit(0);
+            }
+            const bool known = option == "--port" || option == "--binary-port" || option == "--io-threads" ||
+                               option == "--worker-threads" || option == "--execution-threads" ||
+                               option == "--execution-queue" || option == "--workload-class" ||
+                               option == "--cursor-idle-timeout" || option == "--max-open-cursors" ||
+                               option == "--slow-query-log" || option == "--slow-query-ms" ||
+                               option == "--compression-level" || option == "--min-compress-bytes" ||
+                               option == "--max-body-bytes" ||
+                               option == "--keep-alive-timeout" || option == "--write-timeout" ||
+                               option == "--memory-limit" ||
+                               option == "--query-memory" || option == "--statement-timeout-ms" ||
+                               option == "--temp-dir";
+            if (!known) throw std::invalid_argument("Unknown option " + option);
+            if (i + 1 == argc) throw std::invalid_argument("Missing value for " + option);
+            const char* value = argv[++i];
+            if (option == "--port") {
+                config.port = parsePort(option, value);
+            } else if (option == "--binary-port") {
+                config.binary_port = parsePort(option, value);
+            } else if (option == "--io-threads") {
+                config.io_threads = parseNumber(option, value);
+            } else if (option == "--worker-threads") {
+                config.worker_threads = parseNumber(option, value);
+            } else if (option == "--execution-threads") {
+                config.execution_threads = parseNumber(option, value);
+            } else if (option == "--execution-queue") {
+                config.execution_queue_size = parseNumber(option, value);
+            } else if (option == "--workload-class") {
+                if (default_classes) config.workload_classes.clear();
+                default_classes = false;
+                config.workload_classes.push_back(parseWorkloadClass(value));
+            } else if (option == "--cursor-idle-timeout") {
+                config.cursor_idle_timeout_seconds = static_cast<unsigned>(parseNumber(option, value));
+            } else if (option == "--max-open-cursors") {
+                config.max_open_cursors = parseNumber(option, value);
+            } else if (option == "--slow-query-log") {
+                config.slow_query_log = value;
+            } else if (option == "--slow-query-ms") {
+                config.slow_query_threshold_ms = static_cast<unsigned>(parseNumber(option, value));
+            } else if (option == "--compression-level") {
+                config.compression_level = static_cast<int>(std::min<unsigned long long>(parseNumber(option, value), 22));
+            } else if (option == "--min-compress-bytes") {
+                config.min_compress_bytes = parseNumber(option, value);
+            } else if (option == "--max-body-bytes") {
+                config.max_body_bytes = parseNumber(option, value);
+            } else if (option == "--keep-alive-timeout") {
+                config.keep_alive_timeout_seconds = static_cast<unsigned>(parseNumber(option, value));
+            } else if (option == "--write-timeout") {
+                config.write_timeout_seconds = static_cast<unsigned>(parseNumber(option, value));
+            } else if (option == "--memory-limit") {
+                config.executor.global_memory_limit = parseNumber(option, value);
+            } else if (option == "--query-memory") {
+                config.executor.query_memory_budget = parseNumber(option, value);
+            } else if (option == "--statement-timeout-ms") {
+                config.executor.statement_timeout = std::chrono::milliseconds(parseNumber(option, value));
+            } else {
+                config.executor.temp_dir = value;
+            }
         }
-    });
+        return config;
+    }
+}
+
+int main(int argc, char** argv) {
+    ServerConfig config;
+    try {
+        config = parseArgs(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << "\n";
+        printUsage(argv[0]);
+        return 2;
+    }
 
-    std::cout << "Database Server is running on http://localhost:8080" << std::endl;
-    app.port(8080).multithreaded().run();
+    // Не открылся журнал медленных запросов или занят порт
+    try {
+        HttpServer server(std::move(config));
+        server.run();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
     return 0;
-}
\ No newline at end of file
+}
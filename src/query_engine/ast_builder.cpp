@@ -1 +1,19 @@
-#include "query_engine/ast.h"
\ No newline at end of file
+#include "query_engine/ast_builder.h"
+#include "query_engine/parser.h"
+#include "query_engine/query_context.h"
+
+ParsedStatement AstBuilder::build(std::string_view sql) {
+    static Metrics::Histogram& lex_time = queryPhaseHistogram("lex");
+    static Metrics::Histogram& parse_time = queryPhaseHistogram("parse");
+    std::vector<Token> tokens;
+    {
+        Metrics::ScopedTimer timer(lex_time);
+        tokens = Lexer(sql).tokenize();
+    }
+    Metrics::ScopedTimer timer(parse_time);
+    Parser parser(std::move(tokens));
+    ParsedStatement parsed;
+    parsed.ast = parser.parseStatement();
+    parsed.parameter_count = parser.parameterCount();
+    return parsed;
+}
@@ -1 +1,1638 @@
-#include "query_engine/executor.h"
\ No newline at end of file
+#include "query_engine/executor.h"
+#include "query_engine/bloom_filter.h"
+#include "query_engine/plan.h"
+#include "query_engine/spill_file.h"
+#include "storage_engine/table_manager.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+    // Ниже этого размера партиционирование не окупается
+    constexpr size_t kSimpleJoinThreshold = 64 * 1024;
+    // ~256 KB кортежей на партицию — build-таблица партиции помещается в L2
+    constexpr size_t kPartitionTargetTuples = 16 * 1024;
+    // Больше 2048 партиций — scatter начинает упираться в TLB
+    constexpr unsigned kMaxRadixBits = 11;
+    constexpr size_t kMinRowsPerChunk = 4096;
+    // Строк между проверками отмены в построчных операторах
+    constexpr size_t kCancelCheckRows = 4096;
+
+    struct HashedRow {
+        uint64_t hash;
+        size_t row;
+    };
+
+    struct Partitions {
+        std::vector<HashedRow> tuples;
+        std::vector<size_t> offsets; // партиция p — [offsets[p], offsets[p + 1])
+    };
+
+    using MatchList = std::vector<std::pair<size_t, size_t>>; // (probe row, build row)
+
+    // fn(task, worker): worker < min(threads, tasks) — индекс для потоко-локальных структур.
+    // Первое исключение из воркера пробрасывается вызывающему после join.
+    template <typename Fn>
+    void parallelFor(size_t tasks, size_t threads, Fn fn) {
+        threads = std::min(threads, tasks);
+        if (threads <= 1) {
+            for (size_t i = 0; i < tasks; ++i) fn(i, size_t{0});
+            return;
+        }
+        std::atomic<size_t> next{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                try {
+                    for (size_t i = next++; i < tasks; i = next++) fn(i, t);
+                } catch (...) {
+                    next = tasks;
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) error = std::current_exception();
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        if (error) std::rethrow_exception(error);
+    }
+
+    unsigned chooseRadixBits(size_t build_rows) {
+        unsigned bits = 0;
+        while (bits < kMaxRadixBits && (build_rows >> bits) > kPartitionTargetTuples) ++bits;
+        return bits;
+    }
+
+    // Старшие биты хэша — номер партиции, младшие — слот в таблице партиции
+    size_t partitionOf(uint64_t hash, unsigned bits) {
+        return bits == 0 ? 0 : static_cast<size_t>(hash >> (64 - bits));
+    }
+
+    // Каждый поток считает гистограмму своего куска входа, затем пишет
+    // в собственный диапазон внутри каждой партиции — без синхронизации.
+    Partitions radixPartition(const std::vector<Row>& rows, size_t key, unsigned bits, size_t threads,
+                              const QueryContext& ctx) {
+        const size_t fanout = size_t{1} << bits;
+        const size_t chunks = std::max<size_t>(1, std::min(threads, rows.size() / kMinRowsPerChunk));
+        const size_t chunk_size = (rows.size() + chunks - 1) / chunks;
+
+        std::vector<std::vector<uint64_t>> hashes(chunks);
+        std::vector<std::vector<size_t>> histograms(chunks, std::vector<size_t>(fanout, 0));
+
+        parallelFor(chunks, threads, [&](size_t c, size_t) {
+            const size_t begin = std::min(rows.size(), c * chunk_size);
+            const size_t end = std::min(rows.size(), begin + chunk_size);
+            auto& h = hashes[c];
+            auto& hist = histograms[c];
+            h.resize(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                if ((i - begin) % kCancelCheckRows == 0) ctx.checkCancelled();
+                const Value& v = rows[i][key];
+                if (isNull(v)) continue;
+                h[i - begin] = hashValue(v);
+                ++hist[partitionOf(h[i - begin], bits)];
+            }
+        });
+
+        Partitions out;
+        out.offsets.assign(fanout + 1, 0);
+        std::vector<std::vector<size_t>> cursors(chunks, std::vector<size_t>(fanout, 0));
+        size_t pos = 0;
+        for (size_t p = 0; p < fanout; ++p) {
+            out.offsets[p] = pos;
+            for (size_t c = 0; c < chunks; ++c) {
+                cursors[c][p] = pos;
+                pos += histograms[c][p];
+            }
+        }
+        out.offsets[fanout] = pos;
+        out.tuples.resize(pos);
+
+        parallelFor(chunks, threads, [&](size_t c, size_t) {
+            const size_t begin = std::min(rows.size(), c * chunk_size);
+            const size_t end = std::min(rows.size(), begin + chunk_size);
+            const auto& h = hashes[c];
+            auto& cursor = cursors[c];
+            for (size_t i = begin; i < end; ++i) {
+                if ((i - begin) % kCancelCheckRows == 0) ctx.checkCancelled();
+                if (isNull(rows[i][key])) continue;
+                const uint64_t hash = h[i - begin];
+                out.tuples[cursor[partitionOf(hash, bits)]++] = {hash, i};
+            }
+        });
+        return out;
+    }
+
+    void joinPartition(const HashedRow* build, size_t build_n,
+                       const HashedRow* probe, size_t probe_n,
+                       const std::vector<Row>& build_rows, size_t build_key,
+                       const std::vector<Row>& probe_rows, size_t probe_key,
+                       QueryArena& scratch, MatchList& matches) {
+        if (build_n == 0 || probe_n == 0) return;
+
+        size_t capacity = 1;
+        while (capacity < build_n * 2) capacity <<= 1;
+        const size_t mask = capacity - 1;
+
+        // Открытая адресация: индекс кортежа + 1, 0 — пустой слот.
+        // Таблица живёт одну партицию — в арене воркера, без malloc на партицию.
+        uint32_t* slots = scratch.allocateArray<uint32_t>(capacity);
+        std::fill_n(slots, capacity, 0);
+        for (size_t i = 0; i < build_n; ++i) {
+            size_t s = build[i].hash & mask;
+            while (slots[s] != 0) s = (s + 1) & mask;
+            slots[s] = static_cast<uint32_t>(i + 1);
+        }
+
+        for (size_t i = 0; i < probe_n; ++i) {
+            const HashedRow& p = probe[i];
+            const Value& probe_value = probe_rows[p.row][probe_key];
+            for (size_t s = p.hash & mask; slots[s] != 0; s = (s + 1) & mask) {
+                const HashedRow& b = build[slots[s] - 1];
+                if (b.hash == p.hash && build_rows[b.row][build_key] == probe_value) {
+                    matches.emplace_back(p.row, b.row);
+                }
+            }
+        }
+    }
+
+    Row concatRows(const Row& left, const Row& right) {
+        Row row;
+        row.reserve(left.size() + right.size());
+        row.insert(row.end(), left.begin(), left.end());
+        row.insert(row.end(), right.begin(), right.end());
+        return row;
+    }
+
+    std::vector<std::string> concatColumns(const ResultSet& left, const ResultSet& right) {
+        std::vector<std::string> columns = left.columns;
+        columns.insert(columns.end(), right.columns.begin(), right.columns.end());
+        return columns;
+    }
+
+    constexpr size_t kAggMorselRows = 16 * 1024;
+    // Локальная таблица предагрегации: маленькая, чтобы оставаться в кэше.
+    // При переполнении группы сбрасываются в партиции и таблица очищается.
+    // Если сброс почти ничего не схлопнул (много уникальных ключей), лимит растёт.
+    constexpr size_t kPreAggMaxGroups = 4096;
+    constexpr size_t kPreAggGroupsCeiling = 256 * 1024;
+    constexpr size_t kHashBatchRows = 1024;
+
+    struct AggState {
+        Value value;
+        int64_t count = 0;
+    };
+
+    struct Group {
+        uint64_t hash;
+        Row keys;
+        std::vector<AggState> states;
+    };
+
+    Value addValues(const Value& acc, const Value& v) {
+        if (!isNumeric(v)) throw std::runtime_error("SUM/AVG require a numeric column");
+        if (isNull(acc)) return v;
+        if (acc.index() == 1 && v.index() == 1) return std::get<int64_t>(acc) + std::get<int64_t>(v);
+        return toDouble(acc) + toDouble(v);
+    }
+
+    void accumulate(AggState& state, AggregateFunction fn, const Value* v) {
+        if (v == nullptr) { // COUNT(*)
+            ++state.count;
+            return;
+        }
+        if (isNull(*v)) return;
+        ++state.count;
+        switch (fn) {
+            case AggregateFunction::Count:
+                break;
+            case AggregateFunction::Sum:
+            case AggregateFunction::Avg:
+                state.value = addValues(state.value, *v);
+                break;
+            case AggregateFunction::Min:
+                if (isNull(state.value) || compareValues(*v, state.value) < 0) state.value = *v;
+                break;
+            case AggregateFunction::Max:
+                if (isNull(state.value) || compareValues(*v, state.value) > 0) state.value = *v;
+                break;
+        }
+    }
+
+    void mergeState(AggState& into, AggregateFunction fn, const AggState& from) {
+        if (fn != AggregateFunction::Count && !isNull(from.value)) {
+            if (fn == AggregateFunction::Sum || fn == AggregateFunction::Avg) {
+                into.value = addValues(into.value, from.value);
+            } else if (isNull(into.value)) {
+                into.value = from.value;
+            } else {
+                const int c = compareValues(from.value, into.value);
+                if ((fn == AggregateFunction::Min && c < 0) || (fn == AggregateFunction::Max && c > 0)) {
+                    into.value = from.value;
+                }
+            }
+        }
+        into.count += from.count;
+    }
+
+    Value finalizeState(const AggState& state, AggregateFunction fn) {
+        switch (fn) {
+            case AggregateFunction::Count:
+                return state.count;
+            case AggregateFunction::Avg:
+                return state.count == 0 ? Value{} : Value{toDouble(state.value) / static_cast<double>(state.count)};
+            default:
+                return state.value;
+        }
+    }
+
+    // Хэширование ключей пачками по колонке за раз: внутренний цикл идёт по
+    // одной колонке без ветвлений по числу ключей и хорошо разворачивается.
+    void hashKeyColumns(const std::vector<Row>& rows, size_t begin, size_t end,
+                        const std::vector<size_t>& keys, uint64_t* out) {
+        std::fill_n(out, end - begin, 0);
+        for (size_t batch = begin; batch < end; batch += kHashBatchRows) {
+            const size_t batch_end = std::min(end, batch + kHashBatchRows);
+            uint64_t* h = out + (batch - begin);
+            for (size_t k : keys) {
+                for (size_t i = batch; i < batch_end; ++i) {
+                    h[i - batch] = mixHash(h[i - batch] * 0x9e3779b97f4a7c15ULL ^ hashValue(rows[i][k]));
+                }
+            }
+        }
+    }
+
+    class GroupTable {
+    public:
+        explicit GroupTable(size_t expected_groups = 16) { rehash(expected_groups * 2); }
+
+        template <typename Eq, typename Make>
+        Group* findOrInsert(uint64_t hash, Eq eq, Make make) {
+            size_t s = hash & mask_;
+            for (; slots_[s] != 0; s = (s + 1) & mask_) {
+                Group& g = groups_[slots_[s] - 1];
+                if (g.hash == hash && eq(g)) return &g;
+            }
+            groups_.push_back(make());
+            slots_[s] = static_cast<uint32_t>(groups_.size());
+            if (groups_.size() * 2 > slots_.size()) rehash(slots_.size() * 2);
+            return &groups_.back();
+        }
+
+        size_t size() const { return groups_.size(); }
+        std::vector<Group>& groups() { return groups_; }
+
+        void clear() {
+            groups_.clear();
+            std::fill(slots_.begin(), slots_.end(), 0);
+        }
+
+    private:
+        void rehash(size_t capacity) {
+            size_t cap = 16;
+            while (cap < capacity) cap <<= 1;
+            slots_.assign(cap, 0);
+            mask_ = cap - 1;
+            for (size_t i = 0; i < groups_.size(); ++i) {
+                size_t s = groups_[i].hash & mask_;
+                while (slots_[s] != 0) s = (s + 1) & mask_;
+                slots_[s] = static_cast<uint32_t>(i + 1);
+            }
+        }
+
+        std::vector<Group> groups_;
+        std::vector<uint32_t> slots_;
+        size_t mask_ = 0;
+    };
+
+    std::string aggregateName(const AggregateSpec& spec, const std::vector<std::string>& columns) {
+        if (!spec.name.empty()) return spec.name;
+        static const char* names[] = {"count", "sum", "min", "max", "avg"};
+        const std::string arg = spec.column == kStarColumn ? "*" : columns.at(spec.column);
+        return std::string(names[static_cast<int>(spec.function)]) + "(" + arg + ")";
+    }
+
+    constexpr size_t kRadixSortCutoff = 64;
+    // Каждый открытый прогон держит буфер чтения; больше — сливаем в несколько проходов
+    constexpr size_t kMaxMergeFanIn = 64;
+
+    void appendBigEndian(std::string& out, uint64_t x) {
+        for (int shift = 56; shift >= 0; shift -= 8) out.push_back(static_cast<char>(x >> shift));
+    }
+
+    // Нормализованный ключ: побайтовое сравнение (memcmp) даёт нужный порядок,
+    // поэтому сортировка и слияние не разбирают Value.
+    void encodeSortKey(const Row& row, const std::vector<SortKey>& keys, std::string& out) {
+        constexpr uint64_t kSignBit = uint64_t{1} << 63;
+        out.clear();
+        for (const SortKey& key : keys) {
+            const size_t start = out.size();
+            const Value& v = row[key.column];
+            switch (v.index()) {
+                case 0:
+                    out.push_back('\x00');
+                    break;
+                case 1:
+                case 2: {
+                    out.push_back('\x01');
+                    double d = toDouble(v);
+                    if (d == 0.0) d = 0.0;
+                    uint64_t bits;
+                    std::memcpy(&bits, &d, sizeof(bits));
+                    appendBigEndian(out, (bits & kSignBit) ? ~bits : bits | kSignBit);
+                    // int64 за пределами 2^53 различаются только здесь
+                    appendBigEndian(out, v.index() == 1 ? static_cast<uint64_t>(std::get<int64_t>(v)) ^ kSignBit
+                                                        : kSignBit);
+                    break;
+                }
+                case 3:
+                    out.push_back('\x02');
+                    for (char c : std::get<std::string>(v)) {
+                        out.push_back(c);
+                        if (c == '\0') out.push_back('\xFF');
+                    }
+                    out.append(2, '\0');
+                    break;
+            }
+            if (key.descending) {
+                for (size_t i = start; i < out.size(); ++i) out[i] = static_cast<char>(~out[i]);
+            }
+        }
+    }
+
+    // MSD radix sort индексов по байтам ключей, мелкие бакеты — std::sort
+    void radixSortKeys(const std::vector<std::string_view>& keys, size_t* begin, size_t* end,
+                       size_t depth, std::vector<size_t>& scratch) {
+        const size_t n = static_cast<size_t>(end - begin);
+        if (n < kRadixSortCutoff) {
+            std::sort(begin, end, [&](size_t a, size_t b) {
+                return keys[a].substr(depth) < keys[b].substr(depth);
+            });
+            return;
+        }
+        // Бакет 0 — ключ закончился, остальные — байт + 1
+        auto bucketOf = [&](size_t i) {
+            const std::string_view k = keys[i];
+            return k.size() > depth ? static_cast<size_t>(static_cast<uint8_t>(k[depth])) + 1 : 0;
+        };
+        size_t offsets[258] = {};
+        for (size_t* p = begin; p != end; ++p) ++offsets[bucketOf(*p) + 1];
+        for (size_t b = 1; b < 258; ++b) offsets[b] += offsets[b - 1];
+
+        size_t cursor[257];
+        std::copy(offsets, offsets + 257, cursor);
+        scratch.resize(n);
+        for (size_t* p = begin; p != end; ++p) scratch[cursor[bucketOf(*p)]++] = *p;
+        std::copy(scratch.begin(), scratch.begin() + static_cast<std::ptrdiff_t>(n), begin);
+
+        for (size_t b = 1; b < 257; ++b) {
+            if (offsets[b + 1] - offsets[b] > 1) {
+                radixSortKeys(keys, begin + offsets[b], begin + offsets[b + 1], depth + 1, scratch);
+            }
+        }
+    }
+
+    std::vector<size_t> sortedOrder(const std::vector<std::string_view>& keys) {
+        std::vector<size_t> order(keys.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::vector<size_t> scratch;
+        radixSortKeys(keys, order.data(), order.data() + order.size(), 0, scratch);
+        return order;
+    }
+
+    class SortedRunSource : public RowSource {
+    public:
+        SortedRunSource(std::vector<Row> rows, const std::vector<std::string_view>& keys,
+                        std::shared_ptr<QueryContext> ctx, MemoryReservation memory)
+            : ctx_(std::move(ctx)), memory_(std::move(memory)), rows_(std::move(rows)), order_(sortedOrder(keys)) {}
+
+        bool next(Row& row) override {
+            if (pos_ == order_.size()) return false;
+            row = std::move(rows_[order_[pos_++]]);
+            return true;
+        }
+
+    private:
+        std::shared_ptr<QueryContext> ctx_;
+        MemoryReservation memory_;
+        std::vector<Row> rows_;
+        std::vector<size_t> order_;
+        size_t pos_ = 0;
+    };
+
+    // k-путевое слияние прогонов через дерево проигравших: на каждую строку
+    // log2(k) сравнений нормализованных ключей, без перестройки кучи.
+    class MergeSource : public RowSource {
+    public:
+        // ctx держит учёт памяти, в который записаны буферы прогонов
+        MergeSource(std::vector<std::unique_ptr<SpillFile>> runs, std::shared_ptr<QueryContext> ctx)
+            : ctx_(std::move(ctx)), runs_(std::move(runs)), k_(runs_.size()), keys_(k_), rows_(k_), alive_(k_, 0), tree_(k_, k_) {
+            for (size_t i = 0; i < k_; ++i) alive_[i] = runs_[i]->read(keys_[i], rows_[i]);
+            for (size_t i = 0; i < k_; ++i) insertInitial(i);
+        }
+
+        bool next(Row& row) override {
+            std::string key;
+            return nextWithKey(key, row);
+        }
+
+        bool nextWithKey(std::string& key, Row& row) {
+            if (k_ == 0) return false;
+            const size_t winner = tree_[0];
+            if (!alive_[winner]) return false;
+            key.swap(keys_[winner]);
+            row.swap(rows_[winner]);
+            alive_[winner] = runs_[winner]->read(keys_[winner], rows_[winner]);
+            replay(winner);
+            return true;
+        }
+
+    private:
+        bool beats(size_t a, size_t b) const {
+            if (!alive_[a]) return false;
+            if (!alive_[b]) return true;
+            const int c = keys_[a].compare(keys_[b]);
+            return c < 0 || (c == 0 && a < b);
+        }
+
+        // Пока узел пуст, победитель поддерева паркуется в нём
+        void insertInitial(size_t leaf) {
+            size_t winner = leaf;
+            for (size_t t = (leaf + k_) / 2; t > 0; t /= 2) {
+                if (tree_[t] == k_) {
+                    tree_[t] = winner;
+                    return;
+                }
+                if (beats(tree_[t], winner)) std::swap(tree_[t], winner);
+            }
+            tree_[0] = winner;
+        }
+
+        void replay(size_t leaf) {
+            size_t winner = leaf;
+            for (size_t t = (leaf + k_) / 2; t > 0; t /= 2) {
+                if (beats(tree_[t], winner)) std::swap(tree_[t], winner);
+            }
+            tree_[0] = winner;
+        }
+
+        std::shared_ptr<QueryContext> ctx_;
+        std::vector<std::unique_ptr<SpillFile>> runs_;
+        size_t k_;
+        std::vector<std::string> keys_;
+        std::vector<Row> rows_;
+        std::vector<char> alive_;
+        std::vector<size_t> tree_; // tree_[0] — победитель, tree_[1..k-1] — проигравшие
+    };
+
+    std::unique_ptr<SpillFile> spillSortedRun(FileManager& files, QueryMemoryTracker& memory, std::vector<Row>& rows,
+                                              std::vector<std::string_view>& keys) {
+        auto run = std::make_unique<SpillFile>(files, "sort_run", memory);
+        for (size_t i : sortedOrder(keys)) run->write(keys[i], rows[i]);
+        run->finishWriting();
+        rows.clear();
+        keys.clear();
+        return run;
+    }
+
+    int compareByKeys(const Row& a, const Row& b, const std::vector<SortKey>& keys) {
+        for (const SortKey& k : keys) {
+            const int c = compareValues(a[k.column], b[k.column]);
+            if (c != 0) return k.descending ? -c : c;
+        }
+        return 0;
+    }
+
+    // Фильтр, который вышестоящий оператор заполняет во время исполнения
+    // и отдаёт скану: отброшенные строки даже не копируются из источника.
+    class RuntimeFilter {
+    public:
+        virtual ~RuntimeFilter() = default;
+        virtual bool passes(const Row& row) const = 0;
+    };
+
+    using RuntimeFilters = std::vector<std::shared_ptr<const RuntimeFilter>>;
+
+    // Граница заполненной кучи TopN: строка, не лучше худшей в куче, в результат
+    // уже не попадёт.
+    class TopNThreshold : public RuntimeFilter {
+    public:
+        explicit TopNThreshold(std::vector<SortKey> keys) : keys_(std::move(keys)) {}
+
+        void update(const Row& worst) {
+            boundary_.clear();
+            for (const SortKey& k : keys_) boundary_.push_back(worst[k.column]);
+            active_ = true;
+        }
+
+        bool passes(const Row& row) const override {
+            if (!active_) return true;
+            for (size_t i = 0; i < keys_.size(); ++i) {
+                const int c = compareValues(row[keys_[i].column], boundary_[i]);
+                if (c != 0) return (keys_[i].descending ? -c : c) < 0;
+            }
+            return false;
+        }
+
+    private:
+        std::vector<SortKey> keys_;
+        Row boundary_;
+        bool active_ = false;
+    };
+
+    // Bloom-фильтр ключей build-стороны hash join. Пока build не дочитан,
+    // пропускает всё; NULL-ключи во внутреннем соединении не совпадают ни с чем.
+    class BloomJoinFilter : public RuntimeFilter {
+    public:
+        // bits — уже взятый резерв под биты фильтра; ctx держит учёт, в котором он взят
+        BloomJoinFilter(size_t probe_key, size_t expected_build_rows, std::shared_ptr<QueryContext> ctx,
+                        MemoryReservation bits)
+            : ctx_(std::move(ctx)), bits_(std::move(bits)), probe_key_(probe_key), bloom_(expected_build_rows) {}
+
+        void insert(uint64_t hash) { bloom_.insert(hash); }
+        void markReady() { ready_ = true; }
+
+        bool passes(const Row& row) const override {
+            if (!ready_) return true;
+            const Value& v = row[probe_key_];
+            return !isNull(v) && bloom_.mayContain(hashValue(v));
+        }
+
+    private:
+        std::shared_ptr<QueryContext> ctx_;
+        MemoryReservation bits_;
+        size_t probe_key_;
+        BloomFilter bloom_;
+        bool ready_ = false;
+    };
+
+    bool passesFilters(const RuntimeFilters& filters, const Row& row) {
+        for (const auto& filter : filters) {
+            if (!filter->passes(row)) return false;
+        }
+        return true;
+    }
+
+    class ScanSource : public RowSource {
+    public:
+        ScanSource(const ResultSet& input, RuntimeFilters filters, std::shared_ptr<QueryContext> ctx)
+            : rows_(input.rows), filters_(std::move(filters)), ctx_(std::move(ctx)) {}
+
+        bool next(Row& row) override {
+            while (pos_ < rows_.size()) {
+                if (pos_ % kCancelCheckRows == 0) ctx_->checkCancelled();
+                const Row& candidate = rows_[pos_++];
+                if (!passesFilters(filters_, candidate)) continue;
+                row = candidate;
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        const std::vector<Row>& rows_;
+        RuntimeFilters filters_;
+        std::shared_ptr<QueryContext> ctx_;
+        size_t pos_ = 0;
+    };
+
+    // ---- Колоночный скан с поздней материализацией ----
+
+    // Строк в пачке колоночного скана: выборка и собранные строки пачки
+    // остаются в L2
+    constexpr size_t kColumnarBatch = 4096;
+
+    template <typename Pred>
+    void keepRows(std::vector<size_t>& sel, Pred pred) {
+        size_t out = 0;
+        for (size_t row : sel) {
+            if (pred(row)) sel[out++] = row;
+        }
+        sel.resize(out);
+    }
+
+    // Выбор операции вынесен из цикла: внутри — одно типизированное сравнение
+    template <typename T, typename Get>
+    void keepCompared(std::vector<size_t>& sel, const Column& column, CompareOp op, const T& c, Get get) {
+        auto keep = [&](auto cmp) {
+            keepRows(sel, [&](size_t row) { return !column.isNull(row) && cmp(get(row), c); });
+        };
+        switch (op) {
+            case CompareOp::Eq: keep(std::equal_to<>()); break;
+            case CompareOp::Ne: keep(std::not_equal_to<>()); break;
+            case CompareOp::Lt: keep(std::less<>()); break;
+            case CompareOp::Le: keep(std::less_equal<>()); break;
+            case CompareOp::Gt: keep(std::greater<>()); break;
+            case CompareOp::Ge: keep(std::greater_equal<>()); break;
+            case CompareOp::IsNull:
+            case CompareOp::IsNotNull: break;
+        }
+    }
+
+    // Оставляет в sel строки, где предикат истинен. Читает только колонку
+    // предиката и только строки, пережившие предыдущие предикаты.
+    void applyPredicate(const Column& column, const ColumnPredicate& pred, std::vector<size_t>& sel) {
+        if (pred.op == CompareOp::IsNull) return keepRows(sel, [&](size_t row) { return column.isNull(row); });
+        if (pred.op == CompareOp::IsNotNull) return keepRows(sel, [&](size_t row) { return !column.isNull(row); });
+        if (isNull(pred.value)) return sel.clear();
+
+        const bool int_value = std::holds_alternative<int64_t>(pred.value);
+        switch (column.type()) {
+            case ColumnType::Int64:
+                if (int_value) {
+                    return keepCompared(sel, column, pred.op, std::get<int64_t>(pred.value),
+                                        [&](size_t row) { return column.int64At(row); });
+                }
+                if (isNumeric(pred.value)) {
+                    return keepCompared(sel, column, pred.op, toDouble(pred.value),
+                                        [&](size_t row) { return static_cast<double>(column.int64At(row)); });
+                }
+                break;
+            case ColumnType::Double:
+                if (isNumeric(pred.value)) {
+                    return keepCompared(sel, column, pred.op, toDouble(pred.value),
+                                        [&](size_t row) { return column.doubleAt(row); });
+                }
+                break;
+            case ColumnType::String:
+                if (std::holds_alternative<std::string>(pred.value)) {
+                    return keepCompared(sel, column, pred.op, std::string_view(std::get<std::string>(pred.value)),
+                                        [&](size_t row) { return column.stringAt(row); });
+                }
+                break;
+        }
+        // Разные типы: общий порядок compareValues, как у сортировки
+        keepCompared(sel, column, pred.op, 0, [&](size_t row) { return compareValues(column.get(row), pred.value); });
+    }
+
+    // Ожидание блокировки попадает в профиль запроса, если он включён, и
+    // прерывается отменой запроса или его дедлайном
+    std::shared_lock<std::shared_timed_mutex> lockTable(const ColumnarTable& table, QueryContext& ctx) {
+        std::chrono::nanoseconds waited{0};
+        auto lock = table.lockShared(&waited, [&ctx] { ctx.checkCancelled(); });
+        if (ctx.profile()) ctx.profile()->addLockWait(waited);
+        return lock;
+    }
+
+    // Пачка за пачкой: предикаты сужают выборку номеров строк, затем
+    // колонки projection собираются в Row только для оставшихся строк.
+    // Фильтры времени исполнения (Bloom, порог TopN) видят уже собранную строку.
+    //
+    // Таблица только дописывается, поэтому скан читает снимок из строк, что
+    // были при его создании, и берёт блокировку лишь на сборку пачки: потребитель,
+    // который медленно пишет в сокет или стоит курсором, не держит вставки.
+    class ColumnarScanSource : public RowSource {
+    public:
+        ColumnarScanSource(const ColumnarTable& table, std::vector<size_t> projection,
+                           std::vector<ColumnPredicate> predicates, RuntimeFilters filters,
+                           std::shared_ptr<QueryContext> ctx)
+            : table_(table), projection_(std::move(projection)), predicates_(std::move(predicates)),
+              filters_(std::move(filters)), ctx_(std::move(ctx)) {
+            auto lock = lockTable(table_, *ctx_);
+            end_row_ = table_.rowCount();
+        }
+
+        bool next(Row& row) override {
+            while (pos_ == batch_.size()) {
+                if (!loadBatch()) return false;
+            }
+            row = std::move(batch_[pos_++]);
+            return true;
+        }
+
+    private:
+        bool loadBatch() {
+            ctx_->checkCancelled();
+            batch_.clear();
+            pos_ = 0;
+            if (next_row_ >= end_row_) return false;
+            auto lock = lockTable(table_, *ctx_);
+            const size_t end = std::min(next_row_ + kColumnarBatch, end_row_);
+            sel_.resize(end - next_row_);
+            std::iota(sel_.begin(), sel_.end(), next_row_);
+            next_row_ = end;
+
+            for (const auto& pred : predicates_) {
+                if (sel_.empty()) return true;
+                applyPredicate(table_.column(pred.column), pred, sel_);
+            }
+
+            batch_.assign(sel_.size(), Row(projection_.size()));
+            for (size_t i = 0; i < projection_.size(); ++i) {
+                const Column& column = table_.column(projection_[i]);
+                for (size_t j = 0; j < sel_.size(); ++j) batch_[j][i] = column.get(sel_[j]);
+            }
+            if (!filters_.empty()) {
+                batch_.erase(std::remove_if(batch_.begin(), batch_.end(),
+                                            [&](const Row& r) { return !passesFilters(filters_, r); }),
+                             batch_.end());
+            }
+            return true;
+        }
+
+        const ColumnarTable& table_;
+        std::vector<size_t> projection_;
+        std::vector<ColumnPredicate> predicates_;
+        RuntimeFilters filters_;
+        std::shared_ptr<QueryContext> ctx_;
+        size_t end_row_ = 0;
+        size_t next_row_ = 0;
+        std::vector<size_t> sel_;
+        std::vector<Row> batch_;
+        size_t pos_ = 0;
+    };
+
+    class LimitSource : public RowSource {
+    public:
+        LimitSource(std::unique_ptr<RowSource> child, size_t limit, size_t offset)
+            : child_(std::move(child)), limit_(limit), offset_(offset) {}
+
+        bool next(Row& row) override {
+            for (; offset_ > 0; --offset_) {
+                if (!child_->next(row)) return false;
+            }
+            if (limit_ == 0 || !child_->next(row)) return false;
+            if (limit_ != kNoLimit) --limit_;
+            return true;
+        }
+
+    private:
+        std::unique_ptr<RowSource> child_;
+        size_t limit_;
+        size_t offset_;
+    };
+
+    // ORDER BY ... LIMIT: max-куча на limit + offset строк, в вершине — худшая
+    class TopNSource : public RowSource {
+    public:
+        TopNSource(std::unique_ptr<RowSource> child, std::vector<SortKey> keys, size_t limit, size_t offset,
+                   std::shared_ptr<TopNThreshold> threshold, std::shared_ptr<QueryContext> ctx)
+            : child_(std::move(child)), keys_(std::move(keys)), limit_(limit), offset_(offset),
+              threshold_(std::move(threshold)), ctx_(std::move(ctx)), memory_(ctx_->memory()) {}
+
+        bool next(Row& row) override {
+            if (!built_) build();
+            if (pos_ >= heap_.size()) return false;
+            row = std::move(heap_[pos_++]);
+            return true;
+        }
+
+    private:
+        void build() {
+            built_ = true;
+            pos_ = offset_;
+            const size_t capacity = limit_ + offset_;
+            if (limit_ == 0) return;
+
+            auto less = [this](const Row& a, const Row& b) { return compareByKeys(a, b, keys_) < 0; };
+            heap_.reserve(capacity);
+            Row row;
+            while (child_->next(row)) {
+                if (heap_.size() < capacity) {
+                    memory_.grow(estimateRowBytes(row));
+                    heap_.push_back(std::move(row));
+                    std::push_heap(heap_.begin(), heap_.end(), less);
+                } else if (less(row, heap_.front())) {
+                    std::pop_heap(heap_.begin(), heap_.end(), less);
+                    // Вытесненная строка может быть короче новой: строки переменной длины
+                    memory_.shrink(estimateRowBytes(heap_.back()));
+                    memory_.grow(estimateRowBytes(row));
+                    heap_.back() = std::move(row);
+                    std::push_heap(heap_.begin(), heap_.end(), less);
+                } else {
+                    continue;
+                }
+                if (threshold_ && heap_.size() == capacity) threshold_->update(heap_.front());
+            }
+            std::sort_heap(heap_.begin(), heap_.end(), less);
+        }
+
+        std::unique_ptr<RowSource> child_;
+        std::vector<SortKey> keys_;
+        size_t limit_;
+        size_t offset_;
+        std::shared_ptr<TopNThreshold> threshold_;
+        std::shared_ptr<QueryContext> ctx_;
+        MemoryReservation memory_;
+        std::vector<Row> heap_;
+        size_t pos_ = 0;
+        bool built_ = false;
+    };
+
+    // Grace hashing: на уровне depth партиция берёт следующие kGraceBits бит хэша,
+    // поэтому рекурсивное разбиение перекошенной партиции действительно её дробит
+    constexpr unsigned kGraceBits = 6;
+    constexpr size_t kGraceFanout = size_t{1} << kGraceBits;
+    constexpr unsigned kMaxGraceDepth = 8;
+    constexpr size_t kJoinEntryBytes = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+    size_t gracePartition(uint64_t hash, unsigned depth) {
+        return static_cast<size_t>(hash >> (64 - kGraceBits * (depth + 1))) & (kGraceFanout - 1);
+    }
+
+    class SpillFileSource : public RowSource {
+    public:
+        explicit SpillFileSource(std::unique_ptr<SpillFile> file) : file_(std::move(file)) {}
+
+        bool next(Row& row) override { return file_->read(key_, row); }
+
+    private:
+        std::unique_ptr<SpillFile> file_;
+        std::string key_;
+    };
+
+    class JoinTable {
+    public:
+        void build(std::vector<Row> rows, size_t key) {
+            rows_ = std::move(rows);
+            key_ = key;
+            hashes_.resize(rows_.size());
+            size_t capacity = 16;
+            while (capacity < rows_.size() * 2) capacity <<= 1;
+            mask_ = capacity - 1;
+            slots_.assign(capacity, 0);
+            for (size_t i = 0; i < rows_.size(); ++i) {
+                hashes_[i] = hashValue(rows_[i][key_]);
+                size_t s = hashes_[i] & mask_;
+                while (slots_[s] != 0) s = (s + 1) & mask_;
+                slots_[s] = static_cast<uint32_t>(i + 1);
+            }
+        }
+
+        void findMatches(const Value& v, std::vector<size_t>& out) const {
+            out.clear();
+            if (rows_.empty()) return;
+            const uint64_t hash = hashValue(v);
+            for (size_t s = hash & mask_; slots_[s] != 0; s = (s + 1) & mask_) {
+                const size_t i = slots_[s] - 1;
+                if (hashes_[i] == hash && rows_[i][key_] == v) out.push_back(i);
+            }
+        }
+
+        const Row& row(size_t i) const { return rows_[i]; }
+
+        void clear() {
+            std::vector<Row>().swap(rows_);
+            std::vector<uint64_t>().swap(hashes_);
+            std::vector<uint32_t>().swap(slots_);
+        }
+
+    private:
+        std::vector<Row> rows_;
+        std::vector<uint64_t> hashes_;
+        std::vector<uint32_t> slots_;
+        size_t key_ = 0;
+        size_t mask_ = 0;
+    };
+
+    // Потоковый hash join. Build-сторона собирается в память, пока укладывается в
+    // бюджет; если нет — обе стороны разбиваются по хэшу во временные файлы, и пары
+    // партиций соединяются по одной, слишком большие — рекурсивно.
+    class HashJoinSource : public RowSource {
+    public:
+        HashJoinSource(std::unique_ptr<RowSource> probe, size_t probe_key,
+                       std::unique_ptr<RowSource> build, size_t build_key,
+                       bool build_is_left, FileManager& files, std::shared_ptr<QueryContext> ctx,
+                       std::shared_ptr<BloomJoinFilter> bloom = nullptr)
+            : probe_(std::move(probe)), build_(std::move(build)), probe_key_(probe_key), build_key_(build_key),
+              build_is_left_(build_is_left), files_(files), ctx_(std::move(ctx)), table_mem_(ctx_->memory()),
+              bloom_(std::move(bloom)) {}
+
+        bool next(Row& row) override {
+            if (!started_) start();
+            while (match_pos_ == matches_.size()) {
+                if (!nextProbeRow()) return false;
+            }
+            const Row& b = table_.row(matches_[match_pos_++]);
+            row = build_is_left_ ? concatRows(b, probe_row_) : concatRows(probe_row_, b);
+            return true;
+        }
+
+    private:
+        struct GracePartition {
+            std::unique_ptr<SpillFile> build;
+            std::unique_ptr<SpillFile> probe;
+            size_t build_bytes = 0;
+            unsigned depth = 0;
+        };
+
+        void start() {
+            started_ = true;
+            std::vector<Row> rows;
+            bool fits = true;
+            Row row;
+            while (build_->next(row)) {
+                if (isNull(row[build_key_])) continue;
+                if (bloom_) bloom_->insert(hashValue(row[build_key_]));
+                const size_t bytes = estimateRowBytes(row) + kJoinEntryBytes;
+                rows.push_back(std::move(row));
+                if (!table_mem_.tryGrow(bytes)) {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits) {
+                table_.build(std::move(rows), build_key_);
+                build_.reset();
+                if (bloom_) bloom_->markReady();
+                current_probe_ = std::move(probe_);
+                return;
+            }
+
+            table_mem_.reset();
+            auto parts = makePartitions(0);
+            for (Row& r : rows) writeBuild(parts, r);
+            std::vector<Row>().swap(rows);
+            while (build_->next(row)) {
+                if (bloom_ && !isNull(row[build_key_])) bloom_->insert(hashValue(row[build_key_]));
+                writeBuild(parts, row);
+            }
+            build_.reset();
+            // Фильтр готов до чтения probe — отсеянные строки не попадут и в файлы партиций
+            if (bloom_) bloom_->markReady();
+            while (probe_->next(row)) writeProbe(parts, row);
+            probe_.reset();
+            pushPartitions(parts);
+        }
+
+        bool nextProbeRow() {
+            while (true) {
+                if (current_probe_ && current_probe_->next(probe_row_)) {
+                    const Value& v = probe_row_[probe_key_];
+                    if (isNull(v)) continue;
+                    table_.findMatches(v, matches_);
+                    match_pos_ = 0;
+                    if (!matches_.empty()) return true;
+                    continue;
+                }
+                current_probe_.reset();
+                table_.clear();
+                table_mem_.reset();
+                if (!loadNextPartition()) return false;
+            }
+        }
+
+        bool loadNextPartition() {
+            while (!pending_.empty()) {
+                ctx_->checkCancelled();
+                GracePartition part = std::move(pending_.back());
+                pending_.pop_back();
+                if (!table_mem_.tryGrow(part.build_bytes)) {
+                    if (part.depth >= kMaxGraceDepth) {
+                        throw MemoryLimitExceeded("Hash join partition does not fit in query memory");
+                    }
+                    repartition(part);
+                    continue;
+                }
+                std::vector<Row> rows;
+                rows.reserve(part.build->rowCount());
+                std::string key;
+                Row row;
+                while (part.build->read(key, row)) rows.push_back(std::move(row));
+                part.build.reset();
+                table_.build(std::move(rows), build_key_);
+                current_probe_ = std::make_unique<SpillFileSource>(std::move(part.probe));
+                return true;
+            }
+            return false;
+        }
+
+        std::vector<GracePartition> makePartitions(unsigned depth) {
+            std::vector<GracePartition> parts(kGraceFanout);
+            for (auto& part : parts) {
+                part.build = std::make_unique<SpillFile>(files_, "join_build", ctx_->memory());
+                part.probe = std::make_unique<SpillFile>(files_, "join_probe", ctx_->memory());
+                part.depth = depth;
+            }
+            return parts;
+        }
+
+        void writeBuild(std::vector<GracePartition>& parts, const Row& row) {
+            const Value& v = row[build_key_];
+            if (isNull(v)) return;
+            GracePartition& part = parts[gracePartition(hashValue(v), parts.front().depth)];
+            part.build->write({}, row);
+            part.build_bytes += estimateRowBytes(row) + kJoinEntryBytes;
+        }
+
+        void writeProbe(std::vector<GracePartition>& parts, const Row& row) {
+            const Value& v = row[probe_key_];
+            if (isNull(v)) return;
+            parts[gracePartition(hashValue(v), parts.front().depth)].probe->write({}, row);
+        }
+
+        // Пары, где одна из сторон пуста, во внутреннем соединении ничего не дают
+        void pushPartitions(std::vector<GracePartition>& parts) {
+            for (auto& part : parts) {
+                if (part.build->rowCount() == 0 || part.probe->rowCount() == 0) continue;
+                part.build->finishWriting();
+                part.probe->finishWriting();
+                pending_.push_back(std::move(part));
+            }
+        }
+
+        void repartition(GracePartition& part) {
+            auto parts = makePartitions(part.depth + 1);
+            std::string key;
+            Row row;
+            while (part.build->read(key, row)) writeBuild(parts, row);
+            part.build.reset();
+            while (part.probe->read(key, row)) writeProbe(parts, row);
+            part.probe.reset();
+            pushPartitions(parts);
+        }
+
+        std::unique_ptr<RowSource> probe_;
+        std::unique_ptr<RowSource> build_;
+        size_t probe_key_;
+        size_t build_key_;
+        bool build_is_left_;
+        FileManager& files_;
+        std::shared_ptr<QueryContext> ctx_;
+        MemoryReservation table_mem_;
+        std::shared_ptr<BloomJoinFilter> bloom_;
+
+        bool started_ = false;
+        JoinTable table_;
+        std::unique_ptr<RowSource> current_probe_;
+        std::vector<GracePartition> pending_;
+        Row probe_row_;
+        std::vector<size_t> matches_;
+        size_t match_pos_ = 0;
+    };
+
+    size_t groupBytes(const Group& g) {
+        return sizeof(Group) + estimateRowBytes(g.keys) + g.states.capacity() * sizeof(AggState);
+    }
+
+    // Частичная группа на диске: ключ записи — хэш, строка — ключи группы,
+    // затем пара (value, count) на каждый агрегат
+    void writeGroup(SpillFile& file, const Group& g) {
+        Row row;
+        row.reserve(g.keys.size() + 2 * g.states.size());
+        row.insert(row.end(), g.keys.begin(), g.keys.end());
+        for (const AggState& state : g.states) {
+            row.push_back(state.value);
+            row.push_back(state.count);
+        }
+        file.write(std::string(reinterpret_cast<const char*>(&g.hash), sizeof(g.hash)), row);
+    }
+
+    bool readGroup(SpillFile& file, size_t n_keys, Group& g) {
+        std::string key;
+        Row row;
+        if (!file.read(key, row)) return false;
+        std::memcpy(&g.hash, key.data(), sizeof(g.hash));
+        g.keys.assign(std::make_move_iterator(row.begin()),
+                      std::make_move_iterator(row.begin() + static_cast<std::ptrdiff_t>(n_keys)));
+        g.states.resize((row.size() - n_keys) / 2);
+        for (size_t a = 0; a < g.states.size(); ++a) {
+            g.states[a].value = std::move(row[n_keys + 2 * a]);
+            g.states[a].count = std::get<int64_t>(row[n_keys + 2 * a + 1]);
+        }
+        return true;
+    }
+
+    // Группы одной партиции одного воркера: в памяти и уже вытесненные в файл
+    struct AggSpillPartition {
+        std::vector<Group> groups;
+        size_t bytes = 0;
+        std::unique_ptr<SpillFile> file;
+        size_t spilled_bytes = 0;
+    };
+
+    // Слияние частичных групп одной партиции. Если они не помещаются в бюджет,
+    // партиция рекурсивно делится следующими битами хэша через временные файлы.
+    class AggPartitionMerger {
+    public:
+        AggPartitionMerger(const std::vector<AggregateSpec>& aggregates, size_t n_keys,
+                           FileManager& files, const QueryContext& ctx)
+            : aggregates_(aggregates), n_keys_(n_keys), files_(files), ctx_(ctx), memory_(ctx.memory()) {}
+
+        // held — уже учтённая память групп из groups; bytes — все группы партиции
+        void merge(std::vector<Group> groups, std::vector<std::unique_ptr<SpillFile>> files,
+                   MemoryReservation held, size_t bytes, unsigned depth, std::vector<Row>& out) const {
+            // Без файлов все группы уже в памяти, слияние их только сожмёт
+            MemoryReservation reservation = std::move(held);
+            if (files.empty() || reservation.tryGrow(bytes - std::min(bytes, reservation.bytes()))) {
+                mergeInMemory(std::move(groups), files, out);
+                return;
+            }
+            if (depth >= kMaxGraceDepth) {
+                throw MemoryLimitExceeded("Aggregate partition does not fit in query memory");
+            }
+
+            std::vector<std::unique_ptr<SpillFile>> subs(kGraceFanout);
+            std::vector<size_t> sub_bytes(kGraceFanout, 0);
+            auto route = [&](const Group& g) {
+                const size_t p = gracePartition(g.hash, depth);
+                if (!subs[p]) subs[p] = std::make_unique<SpillFile>(files_, "agg_part", memory_);
+                writeGroup(*subs[p], g);
+                sub_bytes[p] += groupBytes(g);
+            };
+            for (const Group& g : groups) route(g);
+            std::vector<Group>().swap(groups);
+            reservation.reset();
+            Group g;
+            for (auto& file : files) {
+                for (size_t n = 0; readGroup(*file, n_keys_, g); ++n) {
+                    if (n % kCancelCheckRows == 0) ctx_.checkCancelled();
+                    route(g);
+                }
+                file.reset();
+            }
+
+            for (size_t p = 0; p < kGraceFanout; ++p) {
+                if (!subs[p]) continue;
+                subs[p]->finishWriting();
+                std::vector<std::unique_ptr<SpillFile>> sub;
+                sub.push_back(std::move(subs[p]));
+                merge({}, std::move(sub), MemoryReservation(memory_), sub_bytes[p], depth + 1, out);
+            }
+        }
+
+    private:
+        void mergeInMemory(std::vector<Group> groups, std::vector<std::unique_ptr<SpillFile>>& files,
+                           std::vector<Row>& out) const {
+            const size_t n_aggs = aggregates_.size();
+            GroupTable merged;
+            auto add = [&](Group& part) {
+                Group* g = merged.findOrInsert(part.hash,
+                    [&](const Group& cand) { return cand.keys == part.keys; },
+                    [&] { return Group{part.hash, part.keys, std::vector<AggState>(n_aggs)}; });
+                for (size_t a = 0; a < n_aggs; ++a) mergeState(g->states[a], aggregates_[a].function, part.states[a]);
+            };
+            for (Group& part : groups) add(part);
+            std::vector<Group>().swap(groups);
+            Group part;
+            for (auto& file : files) {
+                for (size_t n = 0; readGroup(*file, n_keys_, part); ++n) {
+                    if (n % kCancelCheckRows == 0) ctx_.checkCancelled();
+                    add(part);
+                }
+                file.reset();
+            }
+
+            out.reserve(out.size() + merged.size());
+            for (Group& g : merged.groups()) {
+                Row row = std::move(g.keys);
+                for (size_t a = 0; a < n_aggs; ++a) row.push_back(finalizeState(g.states[a], aggregates_[a].function));
+                out.push_back(std::move(row));
+            }
+        }
+
+        const std::vector<AggregateSpec>& aggregates_;
+        size_t n_keys_;
+        FileManager& files_;
+        const QueryContext& ctx_;
+        QueryMemoryTracker& memory_;
+    };
+
+    // Считает строки и время оператора для профиля запроса
+    class ProfiledSource : public RowSource {
+    public:
+        ProfiledSource(std::unique_ptr<RowSource> child, QueryProfile::Operator& profile)
+            : child_(std::move(child)), profile_(profile) {}
+
+        bool next(Row& row) override {
+            const uint64_t call = profile_.calls++;
+            if (call != 0 && call % QueryProfile::kSampleEvery != 0) {
+                if (!child_->next(row)) return false;
+                ++profile_.rows;
+                return true;
+            }
+            const auto start = std::chrono::steady_clock::now();
+            const bool more = child_->next(row);
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            if (call == 0) {
+                profile_.first_call += elapsed;
+            } else {
+                profile_.sampled += elapsed;
+                ++profile_.sampled_calls;
+            }
+            if (more) ++profile_.rows;
+            return more;
+        }
+
+    private:
+        std::unique_ptr<RowSource> child_;
+        QueryProfile::Operator& profile_;
+    };
+
+    std::string operatorName(const PlanNode& node) {
+        switch (node.type) {
+            case PlanNode::Type::Scan:
+                return "Scan";
+            case PlanNode::Type::ColumnarScan:
+                return "ColumnarScan " + node.table->name() +
+                       (node.predicates.empty() ? "" : " (" + std::to_string(node.predicates.size()) + " predicates)");
+            case PlanNode::Type::Sort:
+                return "Sort (" + std::to_string(node.sort_keys.size()) + " keys)";
+            case PlanNode::Type::Limit:
+                return "Limit " + std::to_string(node.limit) + " offset " + std::to_string(node.offset);
+            case PlanNode::Type::TopN:
+                return "TopN " + std::to_string(node.limit) + " offset " + std::to_string(node.offset) +
+                       (node.threshold_pushdown ? " (threshold pushdown)" : "");
+            case PlanNode::Type::HashJoin:
+                return "HashJoin #" + std::to_string(node.left_key) + " = #" + std::to_string(node.right_key) +
+                       (node.bloom_pushdown ? " (bloom pushdown)" : "");
+        }
+        return "?";
+    }
+
+    std::unique_ptr<RowSource> buildSource(const QueryExecutor& executor, const PlanNode& node,
+                                           const std::shared_ptr<QueryContext>& ctx, FileManager& files,
+                                           RuntimeFilters filters, size_t depth = 0);
+
+    std::unique_ptr<RowSource> buildOperator(const QueryExecutor& executor, const PlanNode& node,
+                                             const std::shared_ptr<QueryContext>& ctx, FileManager& files,
+                                             RuntimeFilters filters, size_t depth) {
+        switch (node.type) {
+            case PlanNode::Type::Scan:
+                return std::make_unique<ScanSource>(*node.input, std::move(filters), ctx);
+            case PlanNode::Type::ColumnarScan:
+                return std::make_unique<ColumnarScanSource>(*node.table, node.projection, node.predicates,
+                                                            std::move(filters), ctx);
+            case PlanNode::Type::Sort:
+                return executor.sort(buildSource(executor, *node.children.at(0), ctx, files, {}, depth + 1), node.sort_keys, ctx);
+            case PlanNode::Type::Limit:
+                return std::make_unique<LimitSource>(buildSource(executor, *node.children.at(0), ctx, files, {}, depth + 1),
+                                                     node.limit, node.offset);
+            case PlanNode::Type::TopN: {
+                auto threshold = node.threshold_pushdown ? std::make_shared<TopNThreshold>(node.sort_keys) : nullptr;
+                RuntimeFilters pushed;
+                if (threshold) pushed.push_back(threshold);
+                auto child = buildSource(executor, *node.children.at(0), ctx, files, std::move(pushed), depth + 1);
+                return std::make_unique<TopNSource>(std::move(child), node.sort_keys, node.limit, node.offset,
+                                                    threshold, ctx);
+            }
+            case PlanNode::Type::HashJoin: {
+                const PlanNode& build = *node.children.at(1);
+                std::shared_ptr<BloomJoinFilter> bloom;
+                if (node.bloom_pushdown) {
+                    // Фильтр только ускоряет join: без памяти под биты обходимся без него
+                    const size_t expected = estimateRows(build);
+                    MemoryReservation bits(ctx->memory());
+                    if (bits.tryGrow(BloomFilter::bytesFor(expected))) {
+                        bloom = std::make_shared<BloomJoinFilter>(node.left_key, expected, ctx, std::move(bits));
+                    }
+                }
+                RuntimeFilters pushed;
+                if (bloom) pushed.push_back(bloom);
+                auto probe = buildSource(executor, *node.children.at(0), ctx, files, std::move(pushed), depth + 1);
+                return std::make_unique<HashJoinSource>(std::move(probe), node.left_key,
+                                                        buildSource(executor, build, ctx, files, {}, depth + 1), node.right_key,
+                                                        false, files, ctx, bloom);
+            }
+        }
+        throw std::logic_error("Unknown plan node");
+    }
+
+    // С профилем запроса каждый оператор оборачивается в ProfiledSource;
+    // операторы попадают в профиль в прямом порядке обхода плана
+    std::unique_ptr<RowSource> buildSource(const QueryExecutor& executor, const PlanNode& node,
+                                           const std::shared_ptr<QueryContext>& ctx, FileManager& files,
+                                           RuntimeFilters filters, size_t depth) {
+        QueryProfile* profile = ctx->profile();
+        if (!profile) return buildOperator(executor, node, ctx, files, std::move(filters), depth);
+        QueryProfile::Operator& op = profile->addOperator(operatorName(node), depth);
+        return std::make_unique<ProfiledSource>(buildOperator(executor, node, ctx, files, std::move(filters), depth),
+                                                op);
+    }
+}
+
+QueryExecutor::QueryExecutor(ExecutorConfig config)
+    : config_(std::move(config)),
+      num_threads_(config_.num_threads != 0 ? config_.num_threads
+                                            : std::max<size_t>(1, std::thread::hardware_concurrency())),
+      files_(std::make_shared<FileManager>(config_.temp_dir)),
+      governor_(std::make_shared<MemoryGovernor>(config_.global_memory_limit)),
+      queries_(std::make_shared<QueryRegistry>()) {}
+
+std::shared_ptr<QueryContext> QueryExecutor::createContext(const std::string& query_id, size_t memory_budget,
+                                                          std::chrono::milliseconds timeout) const {
+    const std::string id = query_id.empty() ? "q" + std::to_string(next_query_id_++) : query_id;
+    auto memory = governor_->admit(id, memory_budget != 0 ? memory_budget : config_.query_memory_budget);
+    auto ctx = std::make_shared<QueryContext>(id, std::move(memory), queries_);
+    if (timeout.count() == 0) timeout = config_.statement_timeout;
+    if (timeout.count() != 0) ctx->setDeadline(QueryContext::Clock::now() + timeout);
+    if (!queries_->add(*ctx)) throw std::invalid_argument("Query " + id + " is already running");
+    return ctx;
+}
+
+std::shared_ptr<QueryContext> QueryExecutor::contextOrNew(std::shared_ptr<QueryContext> ctx) const {
+    return ctx ? std::move(ctx) : createContext();
+}
+
+ResultSet QueryExecutor::hashJoin(const ResultSet& left, size_t left_key,
+                                  const ResultSet& right, size_t right_key,
+                                  std::shared_ptr<QueryContext> ctx) const {
+    if (left.rows.size() + right.rows.size() < kSimpleJoinThreshold) {
+        return simpleHashJoin(left, left_key, right, right_key);
+    }
+
+    const bool build_left = left.rows.size() <= right.rows.size();
+    const ResultSet& build = build_left ? left : right;
+    const ResultSet& probe = build_left ? right : left;
+    const size_t build_key = build_left ? left_key : right_key;
+    const size_t probe_key = build_left ? right_key : left_key;
+
+    // Партиции и таблицы radix join не влезают в бюджет — grace join через диск
+    const size_t join_bytes = (left.rows.size() + right.rows.size()) * sizeof(HashedRow)
+                            + build.rows.size() * 2 * sizeof(uint32_t);
+    ctx = contextOrNew(std::move(ctx));
+    MemoryReservation join_mem(ctx->memory());
+    if (!join_mem.tryGrow(join_bytes)) {
+        HashJoinSource join(std::make_unique<ScanSource>(probe, RuntimeFilters{}, ctx), probe_key,
+                            std::make_unique<ScanSource>(build, RuntimeFilters{}, ctx), build_key,
+                            build_left, *files_, ctx);
+        ResultSet result;
+        result.columns = concatColumns(left, right);
+        Row row;
+        while (join.next(row)) result.rows.push_back(std::move(row));
+        return result;
+    }
+
+    const unsigned bits = chooseRadixBits(build.rows.size());
+    const size_t fanout = size_t{1} << bits;
+    const Partitions build_parts = radixPartition(build.rows, build_key, bits, num_threads_, *ctx);
+    const Partitions probe_parts = radixPartition(probe.rows, probe_key, bits, num_threads_, *ctx);
+
+    std::vector<MatchList> matches(fanout);
+    std::vector<ArenaPool::Lease> scratch;
+    for (size_t t = 0; t < std::min(num_threads_, fanout); ++t) scratch.push_back(ctx->leaseArena());
+    parallelFor(fanout, num_threads_, [&](size_t p, size_t worker) {
+        ctx->checkCancelled();
+        const size_t b_begin = build_parts.offsets[p];
+        const size_t p_begin = probe_parts.offsets[p];
+        joinPartition(build_parts.tuples.data() + b_begin, build_parts.offsets[p + 1] - b_begin,
+                      probe_parts.tuples.data() + p_begin, probe_parts.offsets[p + 1] - p_begin,
+                      build.rows, build_key, probe.rows, probe_key, *scratch[worker], matches[p]);
+        scratch[worker]->reset();
+    });
+
+    std::vector<size_t> out_offsets(fanout + 1, 0);
+    for (size_t p = 0; p < fanout; ++p) out_offsets[p + 1] = out_offsets[p] + matches[p].size();
+
+    ResultSet result;
+    result.columns = concatColumns(left, right);
+    result.rows.resize(out_offsets[fanout]);
+    parallelFor(fanout, num_threads_, [&](size_t p, size_t) {
+        ctx->checkCancelled();
+        size_t out = out_offsets[p];
+        for (const auto& [probe_row, build_row] : matches[p]) {
+            const Row& l = build_left ? build.rows[build_row] : probe.rows[probe_row];
+            const Row& r = build_left ? probe.rows[probe_row] : build.rows[build_row];
+            result.rows[out++] = concatRows(l, r);
+        }
+    });
+    return result;
+}
+
+ResultSet QueryExecutor::simpleHashJoin(const ResultSet& left, size_t left_key,
+                                        const ResultSet& right, size_t right_key) const {
+    std::unordered_multimap<Value, size_t> table;
+    table.reserve(right.rows.size());
+    for (size_t i = 0; i < right.rows.size(); ++i) {
+        const Value& v = right.rows[i][right_key];
+        if (!isNull(v)) table.emplace(v, i);
+    }
+
+    ResultSet result;
+    result.columns = concatColumns(left, right);
+    for (const Row& l : left.rows) {
+        const Value& v = l[left_key];
+        if (isNull(v)) continue;
+        auto [it, end] = table.equal_range(v);
+        for (; it != end; ++it) result.rows.push_back(concatRows(l, right.rows[it->second]));
+    }
+    return result;
+}
+
+// Фаза 1: каждый поток агрегирует свои морсели в маленькую локальную таблицу
+// и при переполнении сбрасывает частичные группы в radix-партиции; сверх
+// бюджета партиции уходят во временные файлы.
+// Фаза 2: партиции сливаются параллельно, каждая в свою таблицу — общей
+// хэш-таблицы и блокировок нет.
+ResultSet QueryExecutor::hashAggregate(const ResultSet& input, const std::vector<size_t>& group_keys,
+                                       const std::vector<AggregateSpec>& aggregates,
+                                       std::shared_ptr<QueryContext> ctx) const {
+    ctx = contextOrNew(std::move(ctx));
+    const size_t morsels = (input.rows.size() + kAggMorselRows - 1) / kAggMorselRows;
+    const size_t workers = std::max<size_t>(1, std::min(num_threads_, morsels));
+    const size_t n_aggs = aggregates.size();
+
+    std::vector<GroupTable> local(workers, GroupTable(kPreAggMaxGroups));
+    std::vector<size_t> limits(workers, kPreAggMaxGroups);
+    std::vector<size_t> rows_since_flush(workers, 0);
+    std::vector<std::unique_ptr<MemoryReservation>> worker_mem(workers);
+    for (auto& mem : worker_mem) mem = std::make_unique<MemoryReservation>(ctx->memory());
+    std::vector<std::vector<AggSpillPartition>> parts(workers);
+    for (auto& worker_parts : parts) worker_parts.resize(kGraceFanout);
+
+    auto flush = [&](size_t w) {
+        if (rows_since_flush[w] < 4 * local[w].size()) {
+            limits[w] = std::min(limits[w] * 4, kPreAggGroupsCeiling);
+        }
+        rows_since_flush[w] = 0;
+        size_t flushed = 0;
+        for (Group& g : local[w].groups()) {
+            AggSpillPartition& part = parts[w][gracePartition(g.hash, 0)];
+            const size_t bytes = groupBytes(g);
+            part.bytes += bytes;
+            flushed += bytes;
+            part.groups.push_back(std::move(g));
+        }
+        local[w].clear();
+
+        // Частичные группы не влезают в бюджет запроса — партиции воркера на диск
+        if (!worker_mem[w]->tryGrow(flushed)) {
+            for (AggSpillPartition& part : parts[w]) {
+                if (part.groups.empty()) continue;
+                if (!part.file) part.file = std::make_unique<SpillFile>(*files_, "agg_spill", ctx->memory());
+                for (const Group& g : part.groups) writeGroup(*part.file, g);
+                std::vector<Group>().swap(part.groups);
+                part.spilled_bytes += part.bytes;
+                part.bytes = 0;
+            }
+            worker_mem[w]->reset();
+        }
+    };
+
+    // Хэши морселя — 128 KB на каждый; из арены воркера, а не из общего malloc
+    std::vector<ArenaPool::Lease> scratch;
+    for (size_t w = 0; w < workers; ++w) scratch.push_back(ctx->leaseArena());
+    parallelFor(morsels, workers, [&](size_t m, size_t w) {
+        const size_t begin = m * kAggMorselRows;
+        const size_t end = std::min(input.rows.size(), begin + kAggMorselRows);
+        ctx->checkCancelled();
+        scratch[w]->reset();
+        uint64_t* hashes = scratch[w]->allocateArray<uint64_t>(end - begin);
+        hashKeyColumns(input.rows, begin, end, group_keys, hashes);
+
+        GroupTable& table = local[w];
+        for (size_t i = begin; i < end; ++i) {
+            const Row& row = input.rows[i];
+            if (table.size() >= limits[w]) flush(w);
+            ++rows_since_flush[w];
+            Group* g = table.findOrInsert(hashes[i - begin],
+                [&](const Group& cand) {
+                    for (size_t k = 0; k < group_keys.size(); ++k) {
+                        if (!(cand.keys[k] == row[group_keys[k]])) return false;
+                    }
+                    return true;
+                },
+                [&] {
+                    Group created{hashes[i - begin], {}, std::vector<AggState>(n_aggs)};
+                    created.keys.reserve(group_keys.size());
+                    for (size_t k : group_keys) created.keys.push_back(row[k]);
+                    return created;
+                });
+            for (size_t a = 0; a < n_aggs; ++a) {
+                const AggregateSpec& spec = aggregates[a];
+                accumulate(g->states[a], spec.function,
+                           spec.column == kStarColumn ? nullptr : &row[spec.column]);
+            }
+        }
+    });
+    for (size_t w = 0; w < workers; ++w) flush(w);
+
+    // Частичные группы в памяти уже учтены в worker_mem: резерв переходит
+    // к слиянию их партиции, а не берётся второй раз
+    std::vector<MemoryReservation> held;
+    held.reserve(kGraceFanout);
+    for (size_t p = 0; p < kGraceFanout; ++p) {
+        held.emplace_back(ctx->memory());
+        for (size_t w = 0; w < workers; ++w) worker_mem[w]->transferTo(held[p], parts[w][p].bytes);
+    }
+
+    const AggPartitionMerger merger(aggregates, group_keys.size(), *files_, *ctx);
+    std::vector<std::vector<Row>> partition_rows(kGraceFanout);
+    parallelFor(kGraceFanout, num_threads_, [&](size_t p, size_t) {
+        ctx->checkCancelled();
+        std::vector<Group> groups;
+        std::vector<std::unique_ptr<SpillFile>> spill_files;
+        size_t bytes = 0;
+        for (size_t w = 0; w < workers; ++w) {
+            AggSpillPartition& part = parts[w][p];
+            bytes += part.bytes + part.spilled_bytes;
+            std::move(part.groups.begin(), part.groups.end(), std::back_inserter(groups));
+            std::vector<Group>().swap(part.groups);
+            if (part.file) {
+                part.file->finishWriting();
+                spill_files.push_back(std::move(part.file));
+            }
+        }
+        merger.merge(std::move(groups), std::move(spill_files), std::move(held[p]), bytes, 1, partition_rows[p]);
+    });
+
+    ResultSet result;
+    for (size_t k : group_keys) result.columns.push_back(input.columns.at(k));
+    for (const auto& spec : aggregates) result.columns.push_back(aggregateName(spec, input.columns));
+    for (auto& rows : partition_rows) {
+        for (auto& row : rows) result.rows.push_back(std::move(row));
+    }
+
+    if (group_keys.empty() && result.rows.empty()) {
+        Row row;
+        for (const auto& spec : aggregates) row.push_back(finalizeState(AggState{}, spec.function));
+        result.rows.push_back(std::move(row));
+    }
+    return result;
+}
+
+std::unique_ptr<RowSource> QueryExecutor::sort(std::unique_ptr<RowSource> input, const std::vector<SortKey>& keys,
+                                               std::shared_ptr<QueryContext> ctx) const {
+    ctx = contextOrNew(std::move(ctx));
+    MemoryReservation run_mem(ctx->memory());
+
+    // Нормализованные ключи прогона — в арене: строка на ключ стоила бы malloc
+    // на каждую строку входа. Ключи нужны до сортировки прогона, потом арена сбрасывается.
+    ArenaPool::Lease key_arena = ctx->leaseArena();
+    std::vector<std::unique_ptr<SpillFile>> runs;
+    std::vector<Row> rows;
+    std::vector<std::string_view> sort_keys;
+    Row row;
+    std::string key;
+    while (input->next(row)) {
+        encodeSortKey(row, keys, key);
+        const size_t bytes = estimateRowBytes(row) + sizeof(std::string_view) + key.size() + sizeof(size_t);
+        rows.push_back(std::move(row));
+        sort_keys.push_back(key_arena->copy(key));
+        if (!run_mem.tryGrow(bytes)) {
+            runs.push_back(spillSortedRun(*files_, ctx->memory(), rows, sort_keys));
+            key_arena->reset();
+            run_mem.reset();
+        }
+    }
+
+    if (runs.empty()) {
+        return std::make_unique<SortedRunSource>(std::move(rows), sort_keys, ctx, std::move(run_mem));
+    }
+    if (!rows.empty()) runs.push_back(spillSortedRun(*files_, ctx->memory(), rows, sort_keys));
+
+    while (runs.size() > kMaxMergeFanIn) {
+        std::vector<std::unique_ptr<SpillFile>> merged;
+        for (size_t i = 0; i < runs.size(); i += kMaxMergeFanIn) {
+            const size_t end = std::min(runs.size(), i + kMaxMergeFanIn);
+            std::vector<std::unique_ptr<SpillFile>> group(std::make_move_iterator(runs.begin() + i),
+                                                          std::make_move_iterator(runs.begin() + end));
+            if (group.size() == 1) {
+                merged.push_back(std::move(group.front()));
+                continue;
+            }
+            MergeSource merge(std::move(group), ctx);
+            auto out = std::make_unique<SpillFile>(*files_, "sort_merge", ctx->memory());
+            for (size_t n = 0; merge.nextWithKey(key, row); ++n) {
+                if (n % kCancelCheckRows == 0) ctx->checkCancelled();
+                out->write(key, row);
+            }
+            out->finishWriting();
+            merged.push_back(std::move(out));
+        }
+        runs = std::move(merged);
+    }
+    return std::make_unique<MergeSource>(std::move(runs), ctx);
+}
+
+ResultSet QueryExecutor::sort(ResultSet input, const std::vector<SortKey>& keys,
+                             std::shared_ptr<QueryContext> ctx) const {
+    auto sorted = sort(std::make_unique<ResultSetSource>(std::move(input.rows)), keys, std::move(ctx));
+    ResultSet result;
+    result.columns = std::move(input.columns);
+    Row row;
+    while (sorted->next(row)) result.rows.push_back(std::move(row));
+    return result;
+}
+
+std::unique_ptr<RowSource> QueryExecutor::execute(const PlanNode& plan, std::shared_ptr<QueryContext> ctx) const {
+    return buildSource(*this, plan, contextOrNew(std::move(ctx)), *files_, {});
+}
+
+ResultSet QueryExecutor::executeToResult(const PlanNode& plan, std::shared_ptr<QueryContext> ctx) const {
+    ctx = contextOrNew(std::move(ctx));
+    // Буфер результата вытеснить некуда: сверх бюджета запрос падает, а не процесс
+    MemoryReservation result_mem(ctx->memory());
+    ResultSet result;
+    result.columns = planColumns(plan);
+    auto source = execute(plan, ctx);
+    Row row;
+    while (source->next(row)) {
+        result_mem.grow(estimateRowBytes(row));
+        result.rows.push_back(std::move(row));
+    }
+    return result;
+}
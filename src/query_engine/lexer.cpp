@@ -1 +1,165 @@
-#include "query_engine/lexer.h"
\ No newline at end of file
+#include "query_engine/lexer.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+
+namespace {
+    constexpr std::array<std::string_view, 18> kKeywords = {
+        "SELECT", "FROM", "WHERE", "AND", "ORDER", "BY", "ASC", "DESC", "LIMIT",
+        "OFFSET", "IS", "NOT", "NULL", "CREATE", "TABLE", "INSERT", "INTO", "VALUES"};
+
+    bool isWordStart(char c) { return std::isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+    bool isWordChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+    bool isDigit(char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; }
+}
+
+std::string normalizeQuery(std::string_view sql) {
+    std::vector<Token> tokens;
+    try {
+        tokens = Lexer(sql).tokenize();
+    } catch (const SyntaxError&) {
+        return std::string(sql);
+    }
+    auto is = [](const Token& token, std::string_view symbol) {
+        return token.type == TokenType::Symbol && token.text == symbol;
+    };
+    std::string out;
+    out.reserve(std::min<size_t>(sql.size(), 4096));
+    bool space = false;        // перед следующим токеном нужен пробел
+    bool after_values = false;
+    size_t depth = 0;          // вложенность скобок
+    bool rows_skipped = false;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const Token& token = tokens[i];
+        if (token.type == TokenType::End) break;
+        // Строки VALUES после первой отличаются только литералами: вместо них — ", ..."
+        if (after_values && depth == 0 && is(token, ",") && is(tokens[i + 1], "(")) {
+            size_t level = 0;
+            for (++i; i + 1 < tokens.size(); ++i) {
+                if (is(tokens[i], "(")) ++level;
+                if (is(tokens[i], ")") && --level == 0) break;
+            }
+            if (!rows_skipped) out += ", ...";
+            rows_skipped = true;
+            continue;
+        }
+        const bool closing = is(token, ",") || is(token, ")") || is(token, ";");
+        if (space && !closing) out += ' ';
+        switch (token.type) {
+            case TokenType::Integer:
+            case TokenType::Float:
+            case TokenType::String:
+                out += '?';
+                break;
+            case TokenType::Identifier:
+                if (!token.text.empty() && isWordStart(token.text[0]) &&
+                    std::all_of(token.text.begin(), token.text.end(), isWordChar)) {
+                    out += token.text;
+                } else {
+                    out += '"' + token.text + '"';
+                }
+                break;
+            default:
+                out += token.text;
+        }
+        if (token.type == TokenType::Keyword && token.text == "VALUES") after_values = true;
+        if (is(token, "(")) ++depth;
+        if (is(token, ")") && depth > 0) --depth;
+        space = !is(token, "(");
+    }
+    return out;
+}
+
+std::vector<Token> Lexer::tokenize() {
+    std::vector<Token> tokens;
+    do {
+        tokens.push_back(next());
+    } while (tokens.back().type != TokenType::End);
+    return tokens;
+}
+
+Token Lexer::next() {
+    while (pos_ < sql_.size()) {
+        if (std::isspace(static_cast<unsigned char>(sql_[pos_]))) {
+            ++pos_;
+        } else if (sql_.compare(pos_, 2, "--") == 0) {
+            while (pos_ < sql_.size() && sql_[pos_] != '\n') ++pos_;
+        } else {
+            break;
+        }
+    }
+    if (pos_ == sql_.size()) return {TokenType::End, "", pos_};
+
+    const char c = sql_[pos_];
+    if (isDigit(c) || (c == '.' && pos_ + 1 < sql_.size() && isDigit(sql_[pos_ + 1]))) return number();
+    if (isWordStart(c)) return word();
+    if (c == '\'') return quoted('\'', TokenType::String);
+    if (c == '"') return quoted('"', TokenType::Identifier);
+
+    const size_t start = pos_;
+    for (std::string_view op : {"<=", ">=", "<>", "!="}) {
+        if (sql_.compare(pos_, 2, op) == 0) {
+            pos_ += 2;
+            return {TokenType::Symbol, std::string(op), start};
+        }
+    }
+    if (std::string_view("*,();=<>-?").find(c) != std::string_view::npos) {
+        ++pos_;
+        return {TokenType::Symbol, std::string(1, c), start};
+    }
+    throw SyntaxError(std::string("Unexpected character '") + c + "'", start);
+}
+
+Token Lexer::number() {
+    const size_t start = pos_;
+    bool is_float = false;
+    while (pos_ < sql_.size() && isDigit(sql_[pos_])) ++pos_;
+    if (pos_ < sql_.size() && sql_[pos_] == '.') {
+        is_float = true;
+        ++pos_;
+        while (pos_ < sql_.size() && isDigit(sql_[pos_])) ++pos_;
+    }
+    if (pos_ < sql_.size() && (sql_[pos_] == 'e' || sql_[pos_] == 'E')) {
+        size_t exp = pos_ + 1;
+        if (exp < sql_.size() && (sql_[exp] == '+' || sql_[exp] == '-')) ++exp;
+        if (exp < sql_.size() && isDigit(sql_[exp])) {
+            is_float = true;
+            pos_ = exp;
+            while (pos_ < sql_.size() && isDigit(sql_[pos_])) ++pos_;
+        }
+    }
+    if (pos_ < sql_.size() && isWordChar(sql_[pos_])) throw SyntaxError("Malformed number", start);
+    return {is_float ? TokenType::Float : TokenType::Integer, std::string(sql_.substr(start, pos_ - start)), start};
+}
+
+Token Lexer::word() {
+    const size_t start = pos_;
+    while (pos_ < sql_.size() && isWordChar(sql_[pos_])) ++pos_;
+    std::string text(sql_.substr(start, pos_ - start));
+    std::string upper = text;
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+                   [](unsigned char ch) { return static_cast<char>(std::toupper(ch)); });
+    if (std::find(kKeywords.begin(), kKeywords.end(), upper) != kKeywords.end()) {
+        return {TokenType::Keyword, std::move(upper), start};
+    }
+    return {TokenType::Identifier, std::move(text), start};
+}
+
+// Кавычка внутри удваивается: 'it''s'
+Token Lexer::quoted(char quote, TokenType type) {
+    const size_t start = pos_++;
+    std::string text;
+    while (true) {
+        if (pos_ == sql_.size()) throw SyntaxError("Unterminated quoted literal", start);
+        const char c = sql_[pos_++];
+        if (c != quote) {
+            text += c;
+        } else if (pos_ < sql_.size() && sql_[pos_] == quote) {
+            text += quote;
+            ++pos_;
+        } else {
+            break;
+        }
+    }
+    return {type, std::move(text), start};
+}
@@ -0,0 +1,83 @@
+#include "query_engine/memory_tracker.h"
+#include <algorithm>
+
+namespace {
+    // Меньше этого запросу не хватит даже на буферы спилла
+    constexpr size_t kMinQueryReservation = size_t{4} << 20;
+
+    bool reserveWithin(std::atomic<size_t>& used, size_t bytes, size_t limit) {
+        size_t current = used.load(std::memory_order_relaxed);
+        do {
+            if (current + bytes > limit) return false;
+        } while (!used.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+        return true;
+    }
+}
+
+QueryMemoryTracker::QueryMemoryTracker(std::shared_ptr<MemoryGovernor> governor, std::string query_id, size_t limit)
+    : governor_(std::move(governor)), query_id_(std::move(query_id)), limit_(limit) {}
+
+QueryMemoryTracker::~QueryMemoryTracker() {
+    governor_->release(used_);
+    governor_->unregister(this);
+}
+
+bool QueryMemoryTracker::tryReserve(size_t bytes) {
+    if (!reserveWithin(used_, bytes, limit_)) return false;
+    if (!governor_->tryReserve(bytes)) {
+        used_ -= bytes;
+        return false;
+    }
+    const size_t now = used_.load(std::memory_order_relaxed);
+    size_t peak = peak_.load(std::memory_order_relaxed);
+    while (now > peak && !peak_.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+    return true;
+}
+
+void QueryMemoryTracker::reserve(size_t bytes) {
+    if (!tryReserve(bytes)) {
+        throw MemoryLimitExceeded("Query " + query_id_ + " exceeded its memory limit of "
+                                  + std::to_string(limit_) + " bytes");
+    }
+}
+
+void QueryMemoryTracker::release(size_t bytes) {
+    if (bytes == 0) return;
+    used_ -= bytes;
+    governor_->release(bytes);
+}
+
+MemoryGovernor::MemoryGovernor(size_t global_limit) : limit_(global_limit) {}
+
+std::shared_ptr<QueryMemoryTracker> MemoryGovernor::admit(const std::string& query_id, size_t query_limit) {
+    if (used_ + std::min(query_limit, kMinQueryReservation) > limit_) {
+        throw QueryRejected("Server is out of query memory, try again later");
+    }
+    auto tracker = std::make_shared<QueryMemoryTracker>(shared_from_this(), query_id, query_limit);
+    std::lock_guard<std::mutex> lock(mutex_);
+    queries_.push_back(tracker.get());
+    return tracker;
+}
+
+std::vector<QueryMemoryUsage> MemoryGovernor::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<QueryMemoryUsage> usage;
+    usage.reserve(queries_.size());
+    for (const QueryMemoryTracker* q : queries_) {
+        usage.push_back({q->queryId(), q->used(), q->peak(), q->limit()});
+    }
+    return usage;
+}
+
+bool MemoryGovernor::tryReserve(size_t bytes) {
+    return reserveWithin(used_, bytes, limit_);
+}
+
+void MemoryGovernor::release(size_t bytes) {
+    used_ -= bytes;
+}
+
+void MemoryGovernor::unregister(const QueryMemoryTracker* tracker) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queries_.erase(std::remove(queries_.begin(), queries_.end(), tracker), queries_.end());
+}
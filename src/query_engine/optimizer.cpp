@@ -1 +1,43 @@
-#include "query_engine/optimizer.h"
\ No newline at end of file
+#include "query_engine/optimizer.h"
+
+namespace {
+    // Дальше куча перестаёт помещаться в кэш и внешняя сортировка выгоднее
+    constexpr size_t kMaxTopNRows = 100000;
+
+    // Сканы умеют сами применять фильтры времени исполнения
+    bool isScan(const PlanNode& node) {
+        return node.type == PlanNode::Type::Scan || node.type == PlanNode::Type::ColumnarScan;
+    }
+}
+
+std::unique_ptr<PlanNode> QueryOptimizer::optimize(std::unique_ptr<PlanNode> plan) const {
+    plan = rewriteTopN(std::move(plan));
+    markBloomPushdown(*plan);
+    return plan;
+}
+
+std::unique_ptr<PlanNode> QueryOptimizer::rewriteTopN(std::unique_ptr<PlanNode> node) const {
+    for (auto& child : node->children) child = rewriteTopN(std::move(child));
+
+    if (node->type != PlanNode::Type::Limit || node->limit == kNoLimit) return node;
+    PlanNode& sort = *node->children.at(0);
+    if (sort.type != PlanNode::Type::Sort) return node;
+    // limit + offset может переполниться: огромный OFFSET не должен пройти как маленький
+    if (node->offset > kMaxTopNRows || node->limit > kMaxTopNRows - node->offset) return node;
+
+    auto top_n = std::move(node->children[0]);
+    top_n->type = PlanNode::Type::TopN;
+    top_n->limit = node->limit;
+    top_n->offset = node->offset;
+    // Скан отдаёт строки как есть, поэтому может сам отбрасывать те,
+    // что не лучше текущей худшей строки в куче
+    top_n->threshold_pushdown = isScan(*top_n->children.at(0));
+    return top_n;
+}
+
+void QueryOptimizer::markBloomPushdown(PlanNode& node) const {
+    for (auto& child : node.children) markBloomPushdown(*child);
+    if (node.type == PlanNode::Type::HashJoin) {
+        node.bloom_pushdown = isScan(*node.children.at(0));
+    }
+}
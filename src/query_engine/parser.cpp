@@ -1 +1,216 @@
-#include "query_engine/parser.h"
\ No newline at end of file
+#include "query_engine/parser.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+    std::string toUpper(std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        return s;
+    }
+}
+
+std::unique_ptr<ASTNode> Parser::parseStatement() {
+    std::unique_ptr<ASTNode> statement;
+    if (acceptKeyword("SELECT")) {
+        statement = parseSelect();
+    } else if (acceptKeyword("CREATE")) {
+        statement = parseCreateTable();
+    } else if (acceptKeyword("INSERT")) {
+        statement = parseInsert();
+    } else {
+        fail("SELECT, CREATE or INSERT");
+    }
+    acceptSymbol(";");
+    if (peek().type != TokenType::End) fail("end of statement");
+    return statement;
+}
+
+std::unique_ptr<SelectStatement> Parser::parseSelect() {
+    auto select = std::make_unique<SelectStatement>();
+    if (!acceptSymbol("*")) {
+        do {
+            select->columns.push_back(parseIdentifier());
+        } while (acceptSymbol(","));
+    }
+    expectKeyword("FROM");
+    select->table = parseIdentifier();
+
+    if (acceptKeyword("WHERE")) {
+        do {
+            select->where.push_back(parseCondition());
+        } while (acceptKeyword("AND"));
+    }
+    if (acceptKeyword("ORDER")) {
+        expectKeyword("BY");
+        do {
+            OrderItem item{parseIdentifier()};
+            if (acceptKeyword("DESC")) {
+                item.descending = true;
+            } else {
+                acceptKeyword("ASC");
+            }
+            select->order_by.push_back(std::move(item));
+        } while (acceptSymbol(","));
+    }
+    if (acceptKeyword("LIMIT")) {
+        select->limit = parseCount();
+        if (acceptKeyword("OFFSET")) select->offset = parseCount();
+    }
+    return select;
+}
+
+std::unique_ptr<CreateTableStatement> Parser::parseCreateTable() {
+    expectKeyword("TABLE");
+    auto create = std::make_unique<CreateTableStatement>();
+    create->table = parseIdentifier();
+    expectSymbol("(");
+    do {
+        std::string name = parseIdentifier();
+        create->columns.push_back({std::move(name), parseColumnType()});
+    } while (acceptSymbol(","));
+    expectSymbol(")");
+    return create;
+}
+
+std::unique_ptr<InsertStatement> Parser::parseInsert() {
+    expectKeyword("INTO");
+    auto insert = std::make_unique<InsertStatement>();
+    insert->table = parseIdentifier();
+    expectKeyword("VALUES");
+    do {
+        expectSymbol("(");
+        Row row;
+        do {
+            if (acceptSymbol("?")) {
+                insert->parameters.emplace_back(insert->rows.size(), row.size());
+                ++parameter_count_;
+                row.emplace_back();
+            } else {
+                row.push_back(parseLiteral());
+            }
+        } while (acceptSymbol(","));
+        expectSymbol(")");
+        insert->rows.push_back(std::move(row));
+    } while (acceptSymbol(","));
+    return insert;
+}
+
+Condition Parser::parseCondition() {
+    Condition condition{parseIdentifier(), CompareOp::Eq, Value{}, std::nullopt};
+    if (acceptKeyword("IS")) {
+        condition.op = acceptKeyword("NOT") ? CompareOp::IsNotNull : CompareOp::IsNull;
+        expectKeyword("NULL");
+        return condition;
+    }
+    static const std::pair<const char*, CompareOp> kOps[] = {
+        {"=", CompareOp::Eq}, {"!=", CompareOp::Ne}, {"<>", CompareOp::Ne}, {"<", CompareOp::Lt},
+        {"<=", CompareOp::Le}, {">", CompareOp::Gt}, {">=", CompareOp::Ge}};
+    for (const auto& [symbol, op] : kOps) {
+        if (acceptSymbol(symbol)) {
+            condition.op = op;
+            if (acceptSymbol("?")) {
+                condition.parameter = parameter_count_++;
+            } else {
+                condition.value = parseLiteral();
+            }
+            return condition;
+        }
+    }
+    fail("comparison operator");
+}
+
+Value Parser::parseLiteral() {
+    if (acceptKeyword("NULL")) return Value{};
+    const bool negative = acceptSymbol("-");
+    const Token& token = peek();
+    if (token.type == TokenType::Integer) {
+        errno = 0;
+        const unsigned long long magnitude = std::strtoull(token.text.c_str(), nullptr, 10);
+        const unsigned long long max = static_cast<unsigned long long>(std::numeric_limits<int64_t>::max());
+        if (errno == ERANGE || magnitude > max + (negative ? 1 : 0)) {
+            throw SyntaxError("Integer literal out of range", token.position);
+        }
+        ++pos_;
+        // -9223372036854775808 не помещается в int64 до смены знака
+        return negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+    }
+    if (token.type == TokenType::Float) {
+        const double value = std::strtod(token.text.c_str(), nullptr);
+        ++pos_;
+        return negative ? -value : value;
+    }
+    if (token.type == TokenType::String && !negative) {
+        ++pos_;
+        return tokens_[pos_ - 1].text;
+    }
+    fail("literal");
+}
+
+ColumnType Parser::parseColumnType() {
+    const Token& token = peek();
+    if (token.type != TokenType::Identifier) fail("column type");
+    const std::string type = toUpper(token.text);
+    ColumnType result;
+    if (type == "INT" || type == "INTEGER" || type == "BIGINT") {
+        result = ColumnType::Int64;
+    } else if (type == "DOUBLE" || type == "FLOAT" || type == "REAL") {
+        result = ColumnType::Double;
+    } else if (type == "TEXT" || type == "VARCHAR" || type == "STRING") {
+        result = ColumnType::String;
+    } else {
+        fail("column type");
+    }
+    ++pos_;
+    // VARCHAR(255): длина не ограничивается
+    if (result == ColumnType::String && acceptSymbol("(")) {
+        parseCount();
+        expectSymbol(")");
+    }
+    return result;
+}
+
+size_t Parser::parseCount() {
+    const Token& token = peek();
+    if (token.type != TokenType::Integer) fail("non-negative integer");
+    errno = 0;
+    const unsigned long long value = std::strtoull(token.text.c_str(), nullptr, 10);
+    if (errno == ERANGE || value > std::numeric_limits<size_t>::max()) {
+        throw SyntaxError("Integer literal out of range", token.position);
+    }
+    ++pos_;
+    return static_cast<size_t>(value);
+}
+
+std::string Parser::parseIdentifier() {
+    if (peek().type != TokenType::Identifier) fail("identifier");
+    return tokens_[pos_++].text;
+}
+
+bool Parser::acceptKeyword(const char* keyword) {
+    if (peek().type != TokenType::Keyword || peek().text != keyword) return false;
+    ++pos_;
+    return true;
+}
+
+bool Parser::acceptSymbol(const char* symbol) {
+    if (peek().type != TokenType::Symbol || peek().text != symbol) return false;
+    ++pos_;
+    return true;
+}
+
+void Parser::expectKeyword(const char* keyword) {
+    if (!acceptKeyword(keyword)) fail(keyword);
+}
+
+void Parser::expectSymbol(const char* symbol) {
+    if (!acceptSymbol(symbol)) fail(std::string("'") + symbol + "'");
+}
+
+void Parser::fail(const std::string& expected) const {
+    const Token& token = peek();
+    const std::string found = token.type == TokenType::End ? "end of input" : "'" + token.text + "'";
+    throw SyntaxError("Expected " + expected + ", found " + found, token.position);
+}
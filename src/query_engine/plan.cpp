@@ -0,0 +1,90 @@
+#include "query_engine/plan.h"
+#include "storage_engine/table_manager.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    std::unique_ptr<PlanNode> makeNode(PlanNode::Type type, std::unique_ptr<PlanNode> child) {
+        auto node = std::make_unique<PlanNode>();
+        node->type = type;
+        if (child) node->children.push_back(std::move(child));
+        return node;
+    }
+}
+
+std::unique_ptr<PlanNode> makeScan(const ResultSet& input) {
+    auto node = makeNode(PlanNode::Type::Scan, nullptr);
+    node->input = &input;
+    return node;
+}
+
+std::unique_ptr<PlanNode> makeColumnarScan(const ColumnarTable& table, std::vector<size_t> projection,
+                                           std::vector<ColumnPredicate> predicates) {
+    auto node = makeNode(PlanNode::Type::ColumnarScan, nullptr);
+    node->table = &table;
+    node->projection = std::move(projection);
+    node->predicates = std::move(predicates);
+    return node;
+}
+
+std::unique_ptr<PlanNode> makeSort(std::unique_ptr<PlanNode> child, std::vector<SortKey> keys) {
+    auto node = makeNode(PlanNode::Type::Sort, std::move(child));
+    node->sort_keys = std::move(keys);
+    return node;
+}
+
+std::unique_ptr<PlanNode> makeLimit(std::unique_ptr<PlanNode> child, size_t limit, size_t offset) {
+    auto node = makeNode(PlanNode::Type::Limit, std::move(child));
+    node->limit = limit;
+    node->offset = offset;
+    return node;
+}
+
+std::unique_ptr<PlanNode> makeHashJoin(std::unique_ptr<PlanNode> left, size_t left_key,
+                                       std::unique_ptr<PlanNode> right, size_t right_key) {
+    auto node = makeNode(PlanNode::Type::HashJoin, std::move(left));
+    node->children.push_back(std::move(right));
+    node->left_key = left_key;
+    node->right_key = right_key;
+    return node;
+}
+
+std::vector<std::string> planColumns(const PlanNode& node) {
+    switch (node.type) {
+        case PlanNode::Type::Scan:
+            return node.input->columns;
+        case PlanNode::Type::ColumnarScan: {
+            std::vector<std::string> columns;
+            for (size_t c : node.projection) columns.push_back(node.table->column(c).name());
+            return columns;
+        }
+        case PlanNode::Type::Sort:
+        case PlanNode::Type::Limit:
+        case PlanNode::Type::TopN:
+            return planColumns(*node.children.at(0));
+        case PlanNode::Type::HashJoin: {
+            auto columns = planColumns(*node.children.at(0));
+            auto right = planColumns(*node.children.at(1));
+            columns.insert(columns.end(), right.begin(), right.end());
+            return columns;
+        }
+    }
+    throw std::logic_error("Unknown plan node");
+}
+
+size_t estimateRows(const PlanNode& node) {
+    switch (node.type) {
+        case PlanNode::Type::Scan:
+            return node.input->rows.size();
+        case PlanNode::Type::ColumnarScan:
+            return node.table->rowCount();
+        case PlanNode::Type::Sort:
+            return estimateRows(*node.children.at(0));
+        case PlanNode::Type::Limit:
+        case PlanNode::Type::TopN:
+            return std::min(node.limit, estimateRows(*node.children.at(0)));
+        case PlanNode::Type::HashJoin:
+            return std::max(estimateRows(*node.children.at(0)), estimateRows(*node.children.at(1)));
+    }
+    throw std::logic_error("Unknown plan node");
+}
@@ -0,0 +1,66 @@
+#include "query_engine/query_arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    // Первый блок — на типичную пачку ключей или таблицу партиции; дальше
+    // блоки растут вдвое, чтобы большие операторы не дробились на тысячи блоков
+    constexpr size_t kFirstBlockBytes = 64 * 1024;
+    constexpr size_t kMaxBlockBytes = 8 * 1024 * 1024;
+
+    size_t alignUp(uintptr_t address, size_t alignment) {
+        return static_cast<size_t>((alignment - address % alignment) % alignment);
+    }
+}
+
+void* QueryArena::allocate(size_t bytes, size_t alignment) {
+    for (; current_ < blocks_.size(); ++current_, offset_ = 0) {
+        Block& block = blocks_[current_];
+        const size_t pad = alignUp(reinterpret_cast<uintptr_t>(block.data.get()) + offset_, alignment);
+        if (offset_ + pad + bytes <= block.size) {
+            char* result = block.data.get() + offset_ + pad;
+            offset_ += pad + bytes;
+            return result;
+        }
+    }
+    // Свободных блоков не хватило: новый — с запасом на выравнивание
+    const size_t last = blocks_.empty() ? kFirstBlockBytes / 2 : blocks_.back().size;
+    const size_t size = std::max(std::min(last * 2, kMaxBlockBytes), bytes + alignment);
+    blocks_.push_back({std::unique_ptr<char[]>(new char[size]), size});
+    capacity_ += size;
+    current_ = blocks_.size() - 1;
+    const size_t pad = alignUp(reinterpret_cast<uintptr_t>(blocks_.back().data.get()), alignment);
+    offset_ = pad + bytes;
+    return blocks_.back().data.get() + pad;
+}
+
+std::string_view QueryArena::copy(std::string_view bytes) {
+    if (bytes.empty()) return {};
+    char* data = static_cast<char*>(allocate(bytes.size(), 1));
+    std::memcpy(data, bytes.data(), bytes.size());
+    return {data, bytes.size()};
+}
+
+void QueryArena::reset() {
+    current_ = 0;
+    offset_ = 0;
+}
+
+ArenaPool::Lease::~Lease() {
+    if (arena_) pool_->release(std::move(arena_));
+}
+
+ArenaPool::Lease ArenaPool::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) return Lease(*this, std::make_unique<QueryArena>());
+    std::unique_ptr<QueryArena> arena = std::move(free_.back());
+    free_.pop_back();
+    return Lease(*this, std::move(arena));
+}
+
+void ArenaPool::release(std::unique_ptr<QueryArena> arena) {
+    arena->reset();
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(std::move(arena));
+}
@@ -0,0 +1,48 @@
+#include "query_engine/query_context.h"
+
+Metrics::Histogram& queryPhaseHistogram(const char* phase) {
+    return Metrics::registry()
+        .histogram("db_query_phase_seconds", "Time spent in each phase of query processing", {"phase"})
+        .with({phase});
+}
+
+std::chrono::nanoseconds QueryProfile::Operator::elapsed() const {
+    if (sampled_calls == 0 || calls <= 1) return first_call;
+    return first_call + sampled * static_cast<int64_t>(calls - 1) / static_cast<int64_t>(sampled_calls);
+}
+
+QueryProfile::Operator& QueryProfile::addOperator(std::string name, size_t depth) {
+    Operator& op = operators_.emplace_back();
+    op.name = std::move(name);
+    op.depth = depth;
+    return op;
+}
+
+QueryContext::~QueryContext() {
+    if (registry_) registry_->remove(*this);
+}
+
+void QueryContext::throwCancelled() const {
+    if (cancelled()) throw QueryCancelled("Query " + query_id_ + " was cancelled", false);
+    throw QueryCancelled("Query " + query_id_ + " exceeded its statement timeout", true);
+}
+
+bool QueryRegistry::add(QueryContext& ctx) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queries_.emplace(ctx.queryId(), &ctx).second;
+}
+
+void QueryRegistry::remove(const QueryContext& ctx) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = queries_.find(ctx.queryId());
+    // Контекст, которому отказали в add, не должен снять чужую запись
+    if (it != queries_.end() && it->second == &ctx) queries_.erase(it);
+}
+
+bool QueryRegistry::cancel(const std::string& query_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = queries_.find(query_id);
+    if (it == queries_.end()) return false;
+    it->second->cancel();
+    return true;
+}
@@ -0,0 +1,129 @@
+#include "query_engine/spill_file.h"
+#include <stdexcept>
+
+namespace {
+    // Буфер записи и чтения. Операторы держат по kGraceFanout файлов на
+    // воркер, поэтому буфер на файл небольшой
+    constexpr size_t kSpillBufferBytes = 64 * 1024;
+    constexpr size_t kMinSpillBufferBytes = 4 * 1024;
+
+    template <typename T>
+    void putRaw(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void putBytes(std::string& out, std::string_view bytes) {
+        putRaw(out, static_cast<uint32_t>(bytes.size()));
+        out.append(bytes.data(), bytes.size());
+    }
+
+    template <typename T>
+    bool getRaw(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    bool getBytes(std::istream& in, std::string& bytes) {
+        uint32_t size;
+        if (!getRaw(in, size)) return false;
+        bytes.resize(size);
+        return size == 0 || static_cast<bool>(in.read(bytes.data(), size));
+    }
+}
+
+SpillFile::SpillFile(FileManager& files, const std::string& tag, QueryMemoryTracker& memory)
+    : files_(files), path_(files.createTempFile(tag)), buffer_mem_(memory) {}
+
+SpillFile::~SpillFile() {
+    in_.close();
+    files_.removeFile(path_);
+}
+
+size_t SpillFile::acquireBuffer() {
+    if (buffer_mem_.tryGrow(kSpillBufferBytes)) return kSpillBufferBytes;
+    // Бюджет исчерпан — спилл как раз для этого случая, и отказ в буфере уронил
+    // бы запрос, который он спасает: минимальный буфер учитываем, если влезает,
+    // но выдаём в любом случае
+    buffer_mem_.tryGrow(kMinSpillBufferBytes);
+    return kMinSpillBufferBytes;
+}
+
+void SpillFile::releaseBuffer() {
+    std::string().swap(pending_);
+    std::vector<char>().swap(buffer_);
+    buffer_mem_.reset();
+}
+
+void SpillFile::flushPending() {
+    if (pending_.empty()) return;
+    std::ofstream out(path_, std::ios::binary | std::ios::app);
+    out.write(pending_.data(), static_cast<std::streamsize>(pending_.size()));
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Spill write failed: " + path_);
+    }
+    pending_.clear();
+}
+
+void SpillFile::write(std::string_view key, const Row& row) {
+    if (flush_bytes_ == 0) {
+        flush_bytes_ = acquireBuffer();
+        pending_.reserve(flush_bytes_);
+    }
+    const size_t before = pending_.size();
+    putBytes(pending_, key);
+    putRaw(pending_, static_cast<uint32_t>(row.size()));
+    for (const Value& v : row) {
+        putRaw(pending_, static_cast<uint8_t>(v.index()));
+        switch (v.index()) {
+            case 1: putRaw(pending_, std::get<int64_t>(v)); break;
+            case 2: putRaw(pending_, std::get<double>(v)); break;
+            case 3: putBytes(pending_, std::get<std::string>(v)); break;
+            default: break;
+        }
+    }
+    ++rows_;
+    bytes_ += pending_.size() - before;
+    if (pending_.size() >= flush_bytes_) flushPending();
+}
+
+void SpillFile::finishWriting() {
+    flushPending();
+    // До первого read() файл ждёт своей очереди без буфера
+    releaseBuffer();
+}
+
+bool SpillFile::read(std::string& key, Row& row) {
+    if (read_done_ || rows_ == 0) return false;
+    if (!in_.is_open()) {
+        buffer_.resize(acquireBuffer());
+        in_.rdbuf()->pubsetbuf(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        in_.open(path_, std::ios::binary);
+        if (!in_) {
+            throw std::runtime_error("Cannot reopen spill file: " + path_);
+        }
+    }
+    if (!getBytes(in_, key)) {
+        // Дочитан: дескриптор и буфер больше не нужны
+        in_.close();
+        releaseBuffer();
+        read_done_ = true;
+        return false;
+    }
+    uint32_t columns;
+    if (!getRaw(in_, columns)) throw std::runtime_error("Corrupted spill file: " + path_);
+    row.clear();
+    row.reserve(columns);
+    for (uint32_t i = 0; i < columns; ++i) {
+        uint8_t tag = 0xFF;
+        bool ok = getRaw(in_, tag);
+        switch (tag) {
+            case 0: row.emplace_back(); break;
+            case 1: { int64_t x = 0; ok = ok && getRaw(in_, x); row.emplace_back(x); break; }
+            case 2: { double x = 0; ok = ok && getRaw(in_, x); row.emplace_back(x); break; }
+            case 3: { std::string s; ok = ok && getBytes(in_, s); row.emplace_back(std::move(s)); break; }
+            default: ok = false;
+        }
+        if (!ok) throw std::runtime_error("Corrupted spill file: " + path_);
+    }
+    return true;
+}
@@ -0,0 +1,183 @@
+#include "query_engine/sql_engine.h"
+#include "query_engine/optimizer.h"
+#include "query_engine/plan.h"
+#include <algorithm>
+
+namespace {
+    // Строк между проверками отмены на выдаче результата
+    constexpr size_t kCancelCheckRows = 4096;
+
+    // Источник строк плана вместе со всем, на что он ссылается.
+    // Поля разрушаются в обратном порядке: сначала source_, потом план и таблица.
+    // Проверяет отмену и на выдаче: после сортировки сканы уже не читаются.
+    class PlanSource : public RowSource {
+    public:
+        PlanSource(std::shared_ptr<ColumnarTable> table, std::unique_ptr<PlanNode> plan,
+                   std::shared_ptr<QueryContext> ctx, std::unique_ptr<RowSource> source)
+            : table_(std::move(table)), plan_(std::move(plan)), ctx_(std::move(ctx)), source_(std::move(source)) {}
+
+        bool next(Row& row) override {
+            if (++returned_ % kCancelCheckRows == 0) ctx_->checkCancelled();
+            return source_->next(row);
+        }
+
+    private:
+        std::shared_ptr<ColumnarTable> table_;
+        std::unique_ptr<PlanNode> plan_;
+        std::shared_ptr<QueryContext> ctx_;
+        std::unique_ptr<RowSource> source_;
+        size_t returned_ = 0;
+    };
+
+    size_t resolveColumn(const ColumnarTable& table, const std::string& name) {
+        try {
+            return table.columnIndex(name);
+        } catch (const std::out_of_range& e) {
+            throw QueryError(e.what());
+        }
+    }
+
+    // Сравнение колонки с литералом другого рода упорядочило бы их по типу
+    // и молча отобрало все строки или ни одной
+    void checkComparable(const ColumnarTable& table, size_t column, const Value& value) {
+        if (isNull(value)) return;
+        const bool string_column = table.column(column).type() == ColumnType::String;
+        if (string_column != std::holds_alternative<std::string>(value)) {
+            throw QueryError("Cannot compare " + std::string(string_column ? "text" : "numeric") + " column " +
+                             table.column(column).name() + " with " +
+                             (string_column ? "a number" : "a string"));
+        }
+    }
+}
+
+StatementResult SqlEngine::execute(std::string_view sql, std::shared_ptr<QueryContext> ctx) const {
+    const auto start = QueryContext::Clock::now();
+    auto statement = prepare(sql);
+    if (QueryProfile* profile = ctx ? ctx->profile() : nullptr) {
+        profile->addPhase(QueryProfile::Phase::Parse, QueryContext::Clock::now() - start);
+    }
+    return execute(*statement, {}, std::move(ctx));
+}
+
+std::shared_ptr<const PreparedStatement> SqlEngine::prepare(std::string_view sql) const {
+    return std::shared_ptr<const PreparedStatement>(new PreparedStatement(AstBuilder::build(sql)));
+}
+
+StatementResult SqlEngine::execute(const PreparedStatement& statement, const std::vector<Value>& parameters,
+                                   std::shared_ptr<QueryContext> ctx) const {
+    if (parameters.size() != statement.parameterCount()) {
+        throw QueryError("Statement expects " + std::to_string(statement.parameterCount()) + " parameters, got " +
+                         std::to_string(parameters.size()));
+    }
+    const ASTNode* ast = statement.parsed_.ast.get();
+    if (auto* select_stmt = dynamic_cast<const SelectStatement*>(ast)) {
+        if (parameters.empty()) return select(*select_stmt, std::move(ctx));
+        SelectStatement bound = *select_stmt;
+        for (auto& condition : bound.where) {
+            if (condition.parameter) condition.value = parameters[*condition.parameter];
+        }
+        return select(bound, std::move(ctx));
+    }
+    // SELECT исполняется, пока из результата тянут строки; здесь — только DDL и вставка
+    static Metrics::Histogram& execute_time = queryPhaseHistogram("execute");
+    QueryProfile* profile = ctx ? ctx->profile() : nullptr;
+    PhaseTimer timer(execute_time, profile, QueryProfile::Phase::Execute);
+    if (auto* create = dynamic_cast<const CreateTableStatement*>(ast)) return createTable(*create);
+    if (auto* insert_stmt = dynamic_cast<const InsertStatement*>(ast)) {
+        if (parameters.empty()) return insert(*insert_stmt, ctx.get());
+        InsertStatement bound = *insert_stmt;
+        for (size_t i = 0; i < bound.parameters.size(); ++i) {
+            const auto [row, column] = bound.parameters[i];
+            bound.rows[row][column] = parameters[i];
+        }
+        return insert(bound, ctx.get());
+    }
+    throw QueryError("Unsupported statement");
+}
+
+StatementResult SqlEngine::select(const SelectStatement& statement, std::shared_ptr<QueryContext> ctx) const {
+    auto table = findTable(statement.table);
+
+    std::vector<size_t> projection;
+    if (statement.columns.empty()) {
+        for (size_t i = 0; i < table->columnCount(); ++i) projection.push_back(i);
+    } else {
+        for (const auto& name : statement.columns) projection.push_back(resolveColumn(*table, name));
+    }
+
+    std::vector<ColumnPredicate> predicates;
+    for (const auto& condition : statement.where) {
+        const size_t column = resolveColumn(*table, condition.column);
+        checkComparable(*table, column, condition.value);
+        predicates.push_back({column, condition.op, condition.value});
+    }
+
+    auto plan = makeColumnarScan(*table, projection, std::move(predicates));
+    StatementResult result;
+    result.columns = planColumns(*plan);
+    for (size_t c : projection) result.column_types.push_back(table->column(c).type());
+
+    if (!statement.order_by.empty()) {
+        std::vector<SortKey> keys;
+        for (const auto& item : statement.order_by) {
+            auto it = std::find(result.columns.begin(), result.columns.end(), item.column);
+            if (it == result.columns.end()) {
+                throw QueryError("ORDER BY column " + item.column + " must appear in the select list");
+            }
+            keys.push_back({static_cast<size_t>(it - result.columns.begin()), item.descending});
+        }
+        plan = makeSort(std::move(plan), std::move(keys));
+    }
+    if (statement.limit || statement.offset > 0) {
+        plan = makeLimit(std::move(plan), statement.limit.value_or(kNoLimit), statement.offset);
+    }
+
+    {
+        static Metrics::Histogram& optimize_time = queryPhaseHistogram("optimize");
+        PhaseTimer timer(optimize_time, ctx ? ctx->profile() : nullptr, QueryProfile::Phase::Optimize);
+        plan = QueryOptimizer().optimize(std::move(plan));
+    }
+    if (!ctx) ctx = executor_.createContext();
+    auto source = executor_.execute(*plan, ctx);
+    result.rows = std::make_unique<PlanSource>(std::move(table), std::move(plan), std::move(ctx), std::move(source));
+    return result;
+}
+
+StatementResult SqlEngine::createTable(const CreateTableStatement& statement) const {
+    try {
+        tables_.createTable(statement.table, statement.columns);
+    } catch (const std::invalid_argument& e) {
+        throw QueryError(e.what());
+    }
+    StatementResult result;
+    result.message = "Table " + statement.table + " created";
+    return result;
+}
+
+StatementResult SqlEngine::insert(const InsertStatement& statement, const QueryContext* ctx) const {
+    auto table = findTable(statement.table);
+    {
+        std::chrono::nanoseconds waited{0};
+        ColumnarTable::LockInterrupt interrupt;
+        if (ctx) interrupt = [ctx] { ctx->checkCancelled(); };
+        auto lock = table->lockExclusive(&waited, interrupt);
+        if (QueryProfile* profile = ctx ? ctx->profile() : nullptr) profile->addLockWait(waited);
+        // Либо вставляются все строки, либо ни одной
+        try {
+            for (const Row& row : statement.rows) table->checkRow(row);
+        } catch (const std::invalid_argument& e) {
+            throw QueryError(e.what());
+        }
+        for (const Row& row : statement.rows) table->appendRow(row);
+    }
+    StatementResult result;
+    result.affected_rows = statement.rows.size();
+    result.message = std::to_string(result.affected_rows) + " rows inserted";
+    return result;
+}
+
+std::shared_ptr<ColumnarTable> SqlEngine::findTable(const std::string& name) const {
+    auto table = tables_.getTable(name);
+    if (!table) throw QueryError("Unknown table " + name);
+    return table;
+}
@@ -1 +1,32 @@
-#include "storage_engine/file_manager.h"
\ No newline at end of file
+#include "storage_engine/file_manager.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+FileManager::FileManager(std::string temp_dir) : temp_dir_(std::move(temp_dir)) {
+    if (temp_dir_.empty()) {
+        temp_dir_ = (fs::temp_directory_path() / "vk_sirius_db").string();
+    }
+    fs::create_directories(temp_dir_);
+    // Разные процессы могут делить один temp-каталог
+    instance_tag_ = std::to_string(std::random_device{}());
+}
+
+std::string FileManager::createTempFile(const std::string& tag) {
+    const std::string name = tag + "_" + instance_tag_ + "_" + std::to_string(counter_++) + ".tmp";
+    const std::string path = (fs::path(temp_dir_) / name).string();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot create temp file: " + path);
+    }
+    return path;
+}
+
+void FileManager::removeFile(const std::string& path) noexcept {
+    std::error_code ec;
+    fs::remove(path, ec);
+}
@@ -1 +1,165 @@
-#include "storage_engine/table_manager.h"
\ No newline at end of file
+#include "storage_engine/table_manager.h"
+#include "common/metrics.h"
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+
+namespace {
+    Metrics::Histogram& lockWait(const char* mode) {
+        return Metrics::registry()
+            .histogram("db_table_lock_wait_seconds", "Time spent waiting for a busy table lock", {"mode"})
+            .with({mode});
+    }
+
+    // Отрезок ожидания блокировки между вызовами interrupt
+    constexpr auto kLockPollInterval = std::chrono::milliseconds(50);
+
+    template <typename Lock>
+    void waitForLock(Lock& lock, Metrics::Histogram& wait, std::chrono::nanoseconds* waited,
+                     const ColumnarTable::LockInterrupt& interrupt) {
+        const auto start = std::chrono::steady_clock::now();
+        auto record = [&] {
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            wait.record(elapsed);
+            if (waited) *waited += elapsed;
+        };
+        try {
+            if (!interrupt) {
+                lock.lock();
+            } else {
+                while (!lock.try_lock_for(kLockPollInterval)) interrupt();
+            }
+        } catch (...) {
+            record();
+            throw;
+        }
+        record();
+    }
+}
+
+void Column::append(const Value& value) {
+    if (::isNull(value)) {
+        valid_.push_back(0);
+        switch (type_) {
+            case ColumnType::Int64: ints_.push_back(0); break;
+            case ColumnType::Double: doubles_.push_back(0.0); break;
+            case ColumnType::String: offsets_.push_back(chars_.size()); break;
+        }
+        return;
+    }
+    switch (type_) {
+        case ColumnType::Int64:
+            if (!std::holds_alternative<int64_t>(value)) {
+                throw std::invalid_argument("Column " + name_ + " expects an integer");
+            }
+            ints_.push_back(std::get<int64_t>(value));
+            break;
+        case ColumnType::Double:
+            if (!isNumeric(value)) {
+                throw std::invalid_argument("Column " + name_ + " expects a number");
+            }
+            doubles_.push_back(toDouble(value));
+            break;
+        case ColumnType::String: {
+            if (!std::holds_alternative<std::string>(value)) {
+                throw std::invalid_argument("Column " + name_ + " expects a string");
+            }
+            const std::string& s = std::get<std::string>(value);
+            chars_.insert(chars_.end(), s.begin(), s.end());
+            offsets_.push_back(chars_.size());
+            break;
+        }
+    }
+    valid_.push_back(1);
+}
+
+Value Column::get(size_t row) const {
+    if (isNull(row)) return Value{};
+    switch (type_) {
+        case ColumnType::Int64: return ints_[row];
+        case ColumnType::Double: return doubles_[row];
+        case ColumnType::String: return std::string(stringAt(row));
+    }
+    return Value{};
+}
+
+ColumnarTable::ColumnarTable(std::string name, const std::vector<ColumnSpec>& columns) : name_(std::move(name)) {
+    // Имя колонки должно однозначно находиться через columnIndex
+    std::unordered_set<std::string_view> names;
+    for (const auto& spec : columns) {
+        if (spec.name.empty()) throw std::invalid_argument("Empty column name in table " + name_);
+        if (!names.insert(spec.name).second) {
+            throw std::invalid_argument("Duplicate column " + spec.name + " in table " + name_);
+        }
+    }
+    columns_.reserve(columns.size());
+    for (const auto& spec : columns) columns_.emplace_back(spec.name, spec.type);
+}
+
+void ColumnarTable::checkRow(const Row& row) const {
+    if (row.size() != columns_.size()) {
+        throw std::invalid_argument("Row has " + std::to_string(row.size()) + " values, table " + name_ +
+                                    " has " + std::to_string(columns_.size()) + " columns");
+    }
+    for (size_t i = 0; i < row.size(); ++i) {
+        const Value& v = row[i];
+        if (isNull(v)) continue;
+        const ColumnType type = columns_[i].type();
+        const bool ok = (type == ColumnType::Int64 && std::holds_alternative<int64_t>(v)) ||
+                        (type == ColumnType::Double && isNumeric(v)) ||
+                        (type == ColumnType::String && std::holds_alternative<std::string>(v));
+        if (!ok) throw std::invalid_argument("Type mismatch in column " + columns_[i].name());
+    }
+}
+
+void ColumnarTable::appendRow(const Row& row) {
+    // Сначала проверяем всю строку, чтобы не оставить колонки разной длины
+    checkRow(row);
+    for (size_t i = 0; i < row.size(); ++i) columns_[i].append(row[i]);
+    ++row_count_;
+}
+
+std::shared_lock<std::shared_timed_mutex> ColumnarTable::lockShared(std::chrono::nanoseconds* waited,
+                                                                    const LockInterrupt& interrupt) const {
+    std::shared_lock lock(mutex_, std::try_to_lock);
+    if (lock.owns_lock()) return lock;
+    static Metrics::Histogram& wait = lockWait("shared");
+    waitForLock(lock, wait, waited, interrupt);
+    return lock;
+}
+
+std::unique_lock<std::shared_timed_mutex> ColumnarTable::lockExclusive(std::chrono::nanoseconds* waited,
+                                                                       const LockInterrupt& interrupt) {
+    std::unique_lock lock(mutex_, std::try_to_lock);
+    if (lock.owns_lock()) return lock;
+    static Metrics::Histogram& wait = lockWait("exclusive");
+    waitForLock(lock, wait, waited, interrupt);
+    return lock;
+}
+
+size_t ColumnarTable::columnIndex(const std::string& name) const {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].name() == name) return i;
+    }
+    throw std::out_of_range("No column " + name + " in table " + name_);
+}
+
+std::shared_ptr<ColumnarTable> TableManager::createTable(const std::string& name,
+                                                         const std::vector<ColumnSpec>& columns) {
+    auto table = std::make_shared<ColumnarTable>(name, columns);
+    std::unique_lock lock(mutex_);
+    if (!tables_.emplace(name, table).second) throw std::invalid_argument("Table already exists: " + name);
+    return table;
+}
+
+std::shared_ptr<ColumnarTable> TableManager::getTable(const std::string& name) const {
+    std::shared_lock lock(mutex_);
+    auto it = tables_.find(name);
+    return it == tables_.end() ? nullptr : it->second;
+}
+
+bool TableManager::dropTable(const std::string& name) {
+    std::unique_lock lock(mutex_);
+    return tables_.erase(name) > 0;
+}
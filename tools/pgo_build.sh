@@ -0,0 +1,57 @@
+#!/usr/bin/env bash
+# Сборка database_server с LTO и PGO в два прохода:
+#   1. DB_PGO=GENERATE — сборка с инструментацией;
+#   2. обучающий прогон: db_tpch в процессе и db_ycsb A-F против сервера по HTTP;
+#   3. DB_PGO=USE — пересборка в той же директории по собранным профилям.
+# Результат — $BUILD_DIR/database_server. Параметры — через переменные окружения:
+#   BUILD_DIR        сборочная директория (по умолчанию build-pgo в корне репозитория)
+#   PGO_PORT         порт обучающего сервера (18080)
+#   PGO_TPCH_SCALE   масштаб данных db_tpch (0.1)
+#   PGO_YCSB_RECORDS строк в usertable (50000)
+#   PGO_YCSB_OPS     операций на workload, у E — в 20 раз меньше (20000)
+#   CMAKE_ARGS       дополнительные аргументы cmake, например -DCMAKE_CXX_COMPILER=clang++
+set -euo pipefail
+
+SOURCE_DIR=$(cd "$(dirname "$0")/.." && pwd)
+BUILD_DIR=${BUILD_DIR:-$SOURCE_DIR/build-pgo}
+PORT=${PGO_PORT:-18080}
+JOBS=$(nproc 2>/dev/null || echo 4)
+
+configure() {
+    # shellcheck disable=SC2086
+    cmake -S "$SOURCE_DIR" -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=Release -DDB_ENABLE_LTO=ON \
+        -DDB_BUILD_TOOLS=ON -DDB_PGO="$1" ${CMAKE_ARGS:-}
+}
+
+echo "== instrumented build"
+configure GENERATE
+PGO_DIR=$(sed -n 's/^DB_PGO_DIR:PATH=//p' "$BUILD_DIR/CMakeCache.txt")
+# Профили прошлого прогона от другой версии кода только мешают
+rm -rf "$PGO_DIR"
+cmake --build "$BUILD_DIR" -j "$JOBS" --target database_server db_tpch db_ycsb
+
+echo "== training: analytic queries"
+"$BUILD_DIR/db_tpch" --scale "${PGO_TPCH_SCALE:-0.1}" --repeat 1
+
+echo "== training: YCSB over HTTP"
+"$BUILD_DIR/database_server" --port "$PORT" >/dev/null &
+SERVER=$!
+trap 'kill "$SERVER" 2>/dev/null || true' EXIT
+for _ in $(seq 100); do
+    (exec 3<>"/dev/tcp/127.0.0.1/$PORT") 2>/dev/null && break
+    sleep 0.1
+done
+RECORDS=${PGO_YCSB_RECORDS:-50000}
+OPS=${PGO_YCSB_OPS:-20000}
+"$BUILD_DIR/db_ycsb" --port "$PORT" --records "$RECORDS" --operations "$OPS" --workload A,B,C,D,F
+# Сканы E на порядки дороже точечных запросов: им хватит меньшего числа операций
+"$BUILD_DIR/db_ycsb" --port "$PORT" --records "$RECORDS" --operations $((OPS / 20)) --workload E --skip-load
+# Профили пишутся при нормальном выходе: SIGTERM сервер обрабатывает как остановку
+kill -TERM "$SERVER"
+wait "$SERVER"
+trap - EXIT
+
+echo "== optimized build"
+configure USE
+cmake --build "$BUILD_DIR" -j "$JOBS" --target database_server
+echo "Done: $BUILD_DIR/database_server"
@@ -0,0 +1,147 @@
+#include "tpch_data.h"
+#include "tpch_queries.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Генерирует данные в духе TPC-H в памяти и прогоняет формы аналитических
+// запросов через QueryExecutor, печатая время каждого. Сеть и SQL-парсер не
+// участвуют: меряются только операторы.
+namespace {
+    struct Options {
+        double scale = 0.1;
+        std::vector<int> queries; // пусто — все
+        size_t repeat = 3;
+        uint64_t seed = 42;
+        ExecutorConfig executor;
+    };
+
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "  --scale F              data size, 1.0 = 6M lineitem rows (default 0.1)\n"
+                  << "  --queries LIST         comma-separated query numbers (default all)\n"
+                  << "  --repeat N             runs per query, the first one included (default 3)\n"
+                  << "  --seed N               generator seed (default 42)\n"
+                  << "  --worker-threads N     threads for parallel operators, 0 = hardware threads (default 0)\n"
+                  << "  --memory-limit BYTES   memory for all queries (default 8 GiB)\n"
+                  << "  --query-memory BYTES   per-query budget before spilling (default 2 GiB)\n"
+                  << "  --temp-dir PATH        directory for spill files\n";
+    }
+
+    unsigned long long parseNumber(const std::string& option, const char* text) {
+        char* end = nullptr;
+        const unsigned long long value = std::strtoull(text, &end, 10);
+        if (end == text || *end != '\0' || text[0] == '-') {
+            throw std::invalid_argument("Invalid value for " + option + ": " + text);
+        }
+        return value;
+    }
+
+    std::vector<int> parseQueries(const char* text) {
+        std::vector<int> numbers;
+        const std::string list = text;
+        size_t start = 0;
+        for (size_t comma;; start = comma + 1) {
+            comma = list.find(',', start);
+            const std::string item = list.substr(start, comma == std::string::npos ? comma : comma - start);
+            numbers.push_back(static_cast<int>(parseNumber("--queries", item.c_str())));
+            if (comma == std::string::npos) break;
+        }
+        for (int number : numbers) {
+            const auto& all = Tpch::queries();
+            if (std::none_of(all.begin(), all.end(), [&](const Tpch::Query& q) { return q.number == number; })) {
+                throw std::invalid_argument("No query Q" + std::to_string(number));
+            }
+        }
+        return numbers;
+    }
+
+    Options parseArgs(int argc, char** argv) {
+        Options options;
+        options.executor.query_memory_budget = size_t{2} << 30;
+        options.executor.global_memory_limit = size_t{8} << 30;
+        for (int i = 1; i < argc; ++i) {
+            const std::string option = argv[i];
+            if (option == "--help" || option == "-h") {
+                printUsage(argv[0]);
+                std::exit(0);
+            }
+            const bool known = option == "--scale" || option == "--queries" || option == "--repeat" ||
+                               option == "--seed" || option == "--worker-threads" || option == "--memory-limit" ||
+                               option == "--query-memory" || option == "--temp-dir";
+            if (!known) throw std::invalid_argument("Unknown option " + option);
+            if (i + 1 == argc) throw std::invalid_argument("Missing value for " + option);
+            const char* value = argv[++i];
+            if (option == "--scale") {
+                char* end = nullptr;
+                options.scale = std::strtod(value, &end);
+                if (end == value || *end != '\0' || !(options.scale > 0)) {
+                    throw std::invalid_argument(std::string("Invalid value for --scale: ") + value);
+                }
+            } else if (option == "--queries") {
+                options.queries = parseQueries(value);
+            } else if (option == "--repeat") {
+                options.repeat = std::max<size_t>(1, parseNumber(option, value));
+            } else if (option == "--seed") {
+                options.seed = parseNumber(option, value);
+            } else if (option == "--worker-threads") {
+                options.executor.num_threads = parseNumber(option, value);
+            } else if (option == "--memory-limit") {
+                options.executor.global_memory_limit = parseNumber(option, value);
+            } else if (option == "--query-memory") {
+                options.executor.query_memory_budget = parseNumber(option, value);
+            } else {
+                options.executor.temp_dir = value;
+            }
+        }
+        return options;
+    }
+
+    double millisSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        const Options options = parseArgs(argc, argv);
+        TableManager tables;
+        auto start = std::chrono::steady_clock::now();
+        const size_t lineitems = Tpch::generate(tables, options.scale, options.seed);
+        std::printf("scale %g: %zu lineitem rows generated in %.0f ms\n", options.scale, lineitems,
+                    millisSince(start));
+
+        const QueryExecutor executor(options.executor);
+        std::printf("%-5s %-36s %10s %10s %10s %8s\n", "query", "", "min ms", "median ms", "max ms", "rows");
+        double total = 0;
+        for (const Tpch::Query& query : Tpch::queries()) {
+            if (!options.queries.empty() &&
+                std::find(options.queries.begin(), options.queries.end(), query.number) == options.queries.end()) {
+                continue;
+            }
+            std::vector<double> times;
+            size_t rows = 0;
+            for (size_t run = 0; run < options.repeat; ++run) {
+                const Tpch::Database db{executor, tables, options.scale, executor.createContext()};
+                start = std::chrono::steady_clock::now();
+                rows = query.run(db).rows.size();
+                times.push_back(millisSince(start));
+            }
+            std::sort(times.begin(), times.end());
+            total += times[times.size() / 2];
+            std::printf("Q%-4d %-36s %10.1f %10.1f %10.1f %8zu\n", query.number, query.title, times.front(),
+                        times[times.size() / 2], times.back(), rows);
+        }
+        std::printf("total of medians: %.1f ms\n", total);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
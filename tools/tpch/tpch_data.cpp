@@ -0,0 +1,243 @@
+#include "tpch_data.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Tpch {
+    namespace {
+        constexpr int64_t kStartDate = 19920101;
+        // Заказы — с 1992-01-01 по 1998-12-31 без последних 151 дня:
+        // все строки успевают отгрузиться и прийти
+        constexpr int kOrderDateSpan = 2556 - 151;
+
+        struct Nation {
+            const char* name;
+            int64_t region;
+        };
+        constexpr std::array<Nation, 25> kNations = {{
+            {"ALGERIA", 0}, {"ARGENTINA", 1}, {"BRAZIL", 1}, {"CANADA", 1}, {"EGYPT", 4},
+            {"ETHIOPIA", 0}, {"FRANCE", 3}, {"GERMANY", 3}, {"INDIA", 2}, {"INDONESIA", 2},
+            {"IRAN", 4}, {"IRAQ", 4}, {"JAPAN", 2}, {"JORDAN", 4}, {"KENYA", 0},
+            {"MOROCCO", 0}, {"MOZAMBIQUE", 0}, {"PERU", 1}, {"CHINA", 2}, {"ROMANIA", 3},
+            {"SAUDI ARABIA", 4}, {"VIETNAM", 2}, {"RUSSIA", 3}, {"UNITED KINGDOM", 3}, {"UNITED STATES", 1},
+        }};
+        constexpr std::array<const char*, 5> kRegions = {"AFRICA", "AMERICA", "ASIA", "EUROPE", "MIDDLE EAST"};
+        constexpr std::array<const char*, 5> kSegments = {"AUTOMOBILE", "BUILDING", "FURNITURE", "HOUSEHOLD",
+                                                          "MACHINERY"};
+        constexpr std::array<const char*, 5> kPriorities = {"1-URGENT", "2-HIGH", "3-MEDIUM", "4-NOT SPECIFIED",
+                                                            "5-LOW"};
+        constexpr std::array<const char*, 7> kShipModes = {"REG AIR", "AIR", "RAIL", "SHIP", "TRUCK", "MAIL", "FOB"};
+        constexpr std::array<const char*, 4> kInstructions = {"DELIVER IN PERSON", "COLLECT COD", "NONE",
+                                                              "TAKE BACK RETURN"};
+        constexpr std::array<const char*, 6> kTypeSize = {"STANDARD", "SMALL", "MEDIUM", "LARGE", "ECONOMY", "PROMO"};
+        constexpr std::array<const char*, 5> kTypeFinish = {"ANODIZED", "BURNISHED", "PLATED", "POLISHED",
+                                                            "BRUSHED"};
+        constexpr std::array<const char*, 5> kTypeMetal = {"TIN", "NICKEL", "BRASS", "STEEL", "COPPER"};
+        constexpr std::array<const char*, 5> kContainerSize = {"SM", "LG", "MED", "JUMBO", "WRAP"};
+        constexpr std::array<const char*, 8> kContainerKind = {"CASE", "BOX", "BAG", "JAR", "PKG", "PACK", "CAN",
+                                                               "DRUM"};
+        constexpr std::array<const char*, 24> kColors = {
+            "almond", "antique", "aquamarine", "azure", "beige", "bisque", "black", "blanched",
+            "blue", "blush", "brown", "burlywood", "chartreuse", "chocolate", "coral", "cornflower",
+            "cream", "cyan", "forest", "green", "ivory", "khaki", "lavender", "lemon"};
+
+        // Дни от 1970-01-01 и обратно (H. Hinnant, civil_from_days)
+        int64_t daysFromCivil(int64_t y, int64_t m, int64_t d) {
+            y -= m <= 2;
+            const int64_t era = (y >= 0 ? y : y - 399) / 400;
+            const int64_t yoe = y - era * 400;
+            const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+            const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+            return era * 146097 + doe - 719468;
+        }
+
+        int64_t civilFromDays(int64_t z) {
+            z += 719468;
+            const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+            const int64_t doe = z - era * 146097;
+            const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const int64_t mp = (5 * doy + 2) / 153;
+            const int64_t d = doy - (153 * mp + 2) / 5 + 1;
+            const int64_t m = mp + (mp < 10 ? 3 : -9);
+            const int64_t y = yoe + era * 400 + (m <= 2);
+            return y * 10000 + m * 100 + d;
+        }
+
+        std::string keyed(const char* prefix, int64_t key) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%s#%09lld", prefix, static_cast<long long>(key));
+            return buf;
+        }
+
+        double retailPrice(int64_t partkey) {
+            return static_cast<double>(90000 + (partkey / 10) % 20001 + 100 * (partkey % 1000)) / 100.0;
+        }
+
+        // Поставщик i-й из четырёх у детали, как в dbgen
+        int64_t partSupplier(int64_t partkey, int64_t i, int64_t suppliers) {
+            return (partkey + i * (suppliers / 4 + (partkey - 1) / suppliers)) % suppliers + 1;
+        }
+
+        class Random {
+        public:
+            explicit Random(uint64_t seed) : rng_(seed) {}
+
+            int64_t uniform(int64_t lo, int64_t hi) {
+                return std::uniform_int_distribution<int64_t>(lo, hi)(rng_);
+            }
+            // Деньги: центы в [lo, hi]
+            double money(double lo, double hi) {
+                return static_cast<double>(uniform(std::llround(lo * 100), std::llround(hi * 100))) / 100.0;
+            }
+            template <typename Array>
+            const char* pick(const Array& values) {
+                return values[static_cast<size_t>(uniform(0, static_cast<int64_t>(values.size()) - 1))];
+            }
+
+        private:
+            std::mt19937_64 rng_;
+        };
+    }
+
+    int64_t addDays(int64_t date, int days) {
+        return civilFromDays(daysFromCivil(date / 10000, date / 100 % 100, date % 100) + days);
+    }
+
+    TableSizes sizesFor(double scale) {
+        auto scaled = [scale](double base) { return std::max<size_t>(1, static_cast<size_t>(base * scale)); };
+        return {scaled(10000), scaled(150000), scaled(200000), scaled(1500000)};
+    }
+
+    size_t generate(TableManager& tables, double scale, uint64_t seed) {
+        const TableSizes sizes = sizesFor(scale);
+        const auto suppliers = static_cast<int64_t>(sizes.suppliers);
+        const auto customers = static_cast<int64_t>(sizes.customers);
+        const auto parts = static_cast<int64_t>(sizes.parts);
+        Random random(seed);
+        Row row;
+
+        auto region = tables.createTable("region", {{"r_regionkey", ColumnType::Int64}, {"r_name", ColumnType::String}});
+        for (size_t i = 0; i < kRegions.size(); ++i) {
+            region->appendRow({static_cast<int64_t>(i), std::string(kRegions[i])});
+        }
+
+        auto nation = tables.createTable("nation", {{"n_nationkey", ColumnType::Int64},
+                                                    {"n_name", ColumnType::String},
+                                                    {"n_regionkey", ColumnType::Int64}});
+        for (size_t i = 0; i < kNations.size(); ++i) {
+            nation->appendRow({static_cast<int64_t>(i), std::string(kNations[i].name), kNations[i].region});
+        }
+
+        auto supplier = tables.createTable("supplier", {{"s_suppkey", ColumnType::Int64},
+                                                        {"s_name", ColumnType::String},
+                                                        {"s_nationkey", ColumnType::Int64},
+                                                        {"s_acctbal", ColumnType::Double}});
+        for (int64_t key = 1; key <= suppliers; ++key) {
+            supplier->appendRow({key, keyed("Supplier", key), random.uniform(0, 24), random.money(-999.99, 9999.99)});
+        }
+
+        auto customer = tables.createTable("customer", {{"c_custkey", ColumnType::Int64},
+                                                        {"c_name", ColumnType::String},
+                                                        {"c_nationkey", ColumnType::Int64},
+                                                        {"c_acctbal", ColumnType::Double},
+                                                        {"c_mktsegment", ColumnType::String}});
+        for (int64_t key = 1; key <= customers; ++key) {
+            customer->appendRow({key, keyed("Customer", key), random.uniform(0, 24), random.money(-999.99, 9999.99),
+                                 std::string(random.pick(kSegments))});
+        }
+
+        auto part = tables.createTable("part", {{"p_partkey", ColumnType::Int64},
+                                                {"p_name", ColumnType::String},
+                                                {"p_brand", ColumnType::String},
+                                                {"p_type", ColumnType::String},
+                                                {"p_size", ColumnType::Int64},
+                                                {"p_container", ColumnType::String},
+                                                {"p_retailprice", ColumnType::Double}});
+        auto partsupp = tables.createTable("partsupp", {{"ps_partkey", ColumnType::Int64},
+                                                        {"ps_suppkey", ColumnType::Int64},
+                                                        {"ps_availqty", ColumnType::Int64},
+                                                        {"ps_supplycost", ColumnType::Double}});
+        for (int64_t key = 1; key <= parts; ++key) {
+            std::string name;
+            for (int w = 0; w < 5; ++w) {
+                if (w != 0) name += ' ';
+                name += random.pick(kColors);
+            }
+            const int64_t manufacturer = random.uniform(1, 5);
+            std::string type = std::string(random.pick(kTypeSize)) + " " + random.pick(kTypeFinish) + " " +
+                               random.pick(kTypeMetal);
+            std::string container = std::string(random.pick(kContainerSize)) + " " + random.pick(kContainerKind);
+            part->appendRow({key, std::move(name),
+                             "Brand#" + std::to_string(manufacturer) + std::to_string(random.uniform(1, 5)),
+                             std::move(type), random.uniform(1, 50), std::move(container), retailPrice(key)});
+            for (int64_t i = 0; i < 4; ++i) {
+                partsupp->appendRow({key, partSupplier(key, i, suppliers), random.uniform(1, 9999),
+                                     random.money(1.0, 1000.0)});
+            }
+        }
+
+        auto orders = tables.createTable("orders", {{"o_orderkey", ColumnType::Int64},
+                                                    {"o_custkey", ColumnType::Int64},
+                                                    {"o_orderstatus", ColumnType::String},
+                                                    {"o_totalprice", ColumnType::Double},
+                                                    {"o_orderdate", ColumnType::Int64},
+                                                    {"o_orderpriority", ColumnType::String},
+                                                    {"o_shippriority", ColumnType::Int64}});
+        auto lineitem = tables.createTable("lineitem", {{"l_orderkey", ColumnType::Int64},
+                                                        {"l_partkey", ColumnType::Int64},
+                                                        {"l_suppkey", ColumnType::Int64},
+                                                        {"l_linenumber", ColumnType::Int64},
+                                                        {"l_quantity", ColumnType::Int64},
+                                                        {"l_extendedprice", ColumnType::Double},
+                                                        {"l_discount", ColumnType::Double},
+                                                        {"l_tax", ColumnType::Double},
+                                                        {"l_returnflag", ColumnType::String},
+                                                        {"l_linestatus", ColumnType::String},
+                                                        {"l_shipdate", ColumnType::Int64},
+                                                        {"l_commitdate", ColumnType::Int64},
+                                                        {"l_receiptdate", ColumnType::Int64},
+                                                        {"l_shipinstruct", ColumnType::String},
+                                                        {"l_shipmode", ColumnType::String}});
+        size_t lineitems = 0;
+        for (int64_t key = 1; key <= static_cast<int64_t>(sizes.orders); ++key) {
+            // Каждый третий покупатель без заказов, как в dbgen
+            int64_t custkey;
+            do {
+                custkey = random.uniform(1, customers);
+            } while (custkey % 3 == 0 && customers > 2);
+            const int64_t order_date = addDays(kStartDate, static_cast<int>(random.uniform(0, kOrderDateSpan)));
+            const int64_t lines = random.uniform(1, 7);
+            double total = 0;
+            int64_t shipped = 0;
+            for (int64_t line = 1; line <= lines; ++line) {
+                const int64_t partkey = random.uniform(1, parts);
+                const int64_t quantity = random.uniform(1, 50);
+                const double price = static_cast<double>(quantity) * retailPrice(partkey);
+                const double discount = static_cast<double>(random.uniform(0, 10)) / 100.0;
+                const double tax = static_cast<double>(random.uniform(0, 8)) / 100.0;
+                const int64_t ship_date = addDays(order_date, static_cast<int>(random.uniform(1, 121)));
+                const int64_t commit_date = addDays(order_date, static_cast<int>(random.uniform(30, 90)));
+                const int64_t receipt_date = addDays(ship_date, static_cast<int>(random.uniform(1, 30)));
+                const char* return_flag = receipt_date <= kCurrentDate ? (random.uniform(0, 1) ? "R" : "A") : "N";
+                const bool open = ship_date > kCurrentDate;
+                shipped += open ? 0 : 1;
+                total += price * (1 + tax) * (1 - discount);
+                row = {key, partkey, partSupplier(partkey, random.uniform(0, 3), suppliers), line, quantity, price,
+                       discount, tax, std::string(return_flag), std::string(open ? "O" : "F"), ship_date,
+                       commit_date, receipt_date, std::string(random.pick(kInstructions)),
+                       std::string(random.pick(kShipModes))};
+                lineitem->appendRow(row);
+            }
+            lineitems += static_cast<size_t>(lines);
+            const char* status = shipped == lines ? "F" : shipped == 0 ? "O" : "P";
+            orders->appendRow({key, custkey, std::string(status), std::round(total * 100) / 100, order_date,
+                               std::string(random.pick(kPriorities)), int64_t{0}});
+        }
+        return lineitems;
+    }
+}
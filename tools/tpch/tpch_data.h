@@ -0,0 +1,28 @@
+#pragma once
+#include "storage_engine/table_manager.h"
+#include <cstddef>
+#include <cstdint>
+
+// Схема и данные в духе TPC-H: восемь таблиц, размеры пропорциональны
+// scale (1.0 — 6 млн строк lineitem). Распределения — как у dbgen, но не
+// побайтово: данные годятся для сравнения сборок между собой, не для
+// официальных результатов. Даты — int64 вида YYYYMMDD.
+namespace Tpch {
+    // Дата, от которой считаются статусы строк и заказов ("текущая" дата dbgen)
+    constexpr int64_t kCurrentDate = 19950617;
+
+    struct TableSizes {
+        size_t suppliers;
+        size_t customers;
+        size_t parts;
+        size_t orders;
+    };
+    TableSizes sizesFor(double scale);
+
+    // Создаёт region, nation, supplier, customer, part, partsupp, orders, lineitem.
+    // Бросает std::invalid_argument, если таблицы уже есть. Возвращает число строк lineitem.
+    size_t generate(TableManager& tables, double scale, uint64_t seed = 42);
+
+    // YYYYMMDD + days
+    int64_t addDays(int64_t date, int days);
+}
@@ -0,0 +1,477 @@
+#include "tpch_queries.h"
+#include "query_engine/optimizer.h"
+#include "query_engine/plan.h"
+#include "tpch_data.h"
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+
+namespace Tpch {
+    namespace {
+        using Plan = std::unique_ptr<PlanNode>;
+        using AF = AggregateFunction;
+
+        struct Pred {
+            const char* column;
+            CompareOp op;
+            Value value;
+        };
+
+        struct Agg {
+            AggregateFunction function;
+            const char* column; // nullptr — COUNT(*)
+            const char* name;
+        };
+
+        struct Order {
+            const char* column;
+            bool descending;
+        };
+
+        size_t indexOf(const std::vector<std::string>& columns, const std::string& name) {
+            auto it = std::find(columns.begin(), columns.end(), name);
+            if (it == columns.end()) throw std::logic_error("No column " + name);
+            return static_cast<size_t>(it - columns.begin());
+        }
+
+        size_t col(const ResultSet& rows, const char* name) { return indexOf(rows.columns, name); }
+
+        double num(const Row& row, size_t column) { return toDouble(row[column]); }
+        int64_t int64(const Row& row, size_t column) { return std::get<int64_t>(row[column]); }
+        const std::string& str(const Row& row, size_t column) { return std::get<std::string>(row[column]); }
+
+        Plan scan(const Database& db, const char* name, std::initializer_list<const char*> columns,
+                  std::initializer_list<Pred> predicates = {}) {
+            auto table = db.tables.getTable(name);
+            if (!table) throw std::logic_error(std::string("No table ") + name + ", run the generator first");
+            std::vector<size_t> projection;
+            for (const char* column : columns) projection.push_back(table->columnIndex(column));
+            std::vector<ColumnPredicate> resolved;
+            for (const Pred& p : predicates) resolved.push_back({table->columnIndex(p.column), p.op, p.value});
+            return makeColumnarScan(*table, std::move(projection), std::move(resolved));
+        }
+
+        // Промежуточный результат как вход плана; rows должен пережить исполнение
+        Plan scan(const ResultSet& rows) { return makeScan(rows); }
+
+        // build — правая сторона, её строки попадают в хеш-таблицу
+        Plan join(Plan probe, const char* probe_key, Plan build, const char* build_key) {
+            const size_t left = indexOf(planColumns(*probe), probe_key);
+            const size_t right = indexOf(planColumns(*build), build_key);
+            return makeHashJoin(std::move(probe), left, std::move(build), right);
+        }
+
+        ResultSet run(const Database& db, Plan plan) {
+            plan = QueryOptimizer().optimize(std::move(plan));
+            return db.executor.executeToResult(*plan, db.ctx);
+        }
+
+        // Новая колонка name = fn(строка)
+        template <typename Fn>
+        void derive(ResultSet& rows, const char* name, Fn fn) {
+            rows.columns.push_back(name);
+            for (Row& row : rows.rows) {
+                Value value = fn(static_cast<const Row&>(row));
+                row.push_back(std::move(value));
+            }
+        }
+
+        template <typename Fn>
+        void keep(ResultSet& rows, Fn predicate) {
+            rows.rows.erase(std::remove_if(rows.rows.begin(), rows.rows.end(),
+                                           [&](const Row& row) { return !predicate(row); }),
+                            rows.rows.end());
+        }
+
+        void rename(ResultSet& rows, const char* from, const char* to) { rows.columns[col(rows, from)] = to; }
+
+        ResultSet aggregate(const Database& db, const ResultSet& rows, std::initializer_list<const char*> keys,
+                            std::initializer_list<Agg> aggregates) {
+            std::vector<size_t> key_columns;
+            for (const char* key : keys) key_columns.push_back(col(rows, key));
+            std::vector<AggregateSpec> specs;
+            for (const Agg& a : aggregates) {
+                specs.push_back({a.function, a.column ? col(rows, a.column) : kStarColumn, a.name});
+            }
+            return db.executor.hashAggregate(rows, key_columns, specs, db.ctx);
+        }
+
+        // ORDER BY, с limit — через TopN
+        ResultSet order(const Database& db, const ResultSet& rows, std::initializer_list<Order> keys,
+                        size_t limit = kNoLimit) {
+            std::vector<SortKey> sort_keys;
+            for (const Order& key : keys) sort_keys.push_back({col(rows, key.column), key.descending});
+            Plan plan = makeSort(scan(rows), std::move(sort_keys));
+            if (limit != kNoLimit) plan = makeLimit(std::move(plan), limit);
+            return run(db, std::move(plan));
+        }
+
+        // l_extendedprice * (1 - l_discount)
+        void deriveRevenue(ResultSet& rows, const char* name = "revenue") {
+            const size_t price = col(rows, "l_extendedprice");
+            const size_t discount = col(rows, "l_discount");
+            derive(rows, name, [=](const Row& r) { return num(r, price) * (1 - num(r, discount)); });
+        }
+
+        bool oneOf(const std::string& value, std::initializer_list<const char*> options) {
+            return std::any_of(options.begin(), options.end(), [&](const char* o) { return value == o; });
+        }
+
+        Value i64(int64_t v) { return v; }
+        Value text(const char* v) { return std::string(v); }
+
+        // Q1: сводка по ценам — скан почти всей lineitem и агрегация в четыре группы
+        ResultSet q1(const Database& db) {
+            ResultSet rows = run(db, scan(db, "lineitem",
+                                          {"l_returnflag", "l_linestatus", "l_quantity", "l_extendedprice",
+                                           "l_discount", "l_tax"},
+                                          {{"l_shipdate", CompareOp::Le, i64(19980902)}}));
+            deriveRevenue(rows, "disc_price");
+            const size_t disc_price = col(rows, "disc_price");
+            const size_t tax = col(rows, "l_tax");
+            derive(rows, "charge", [=](const Row& r) { return num(r, disc_price) * (1 + num(r, tax)); });
+            ResultSet result = aggregate(db, rows, {"l_returnflag", "l_linestatus"},
+                                         {{AF::Sum, "l_quantity", "sum_qty"},
+                                          {AF::Sum, "l_extendedprice", "sum_base_price"},
+                                          {AF::Sum, "disc_price", "sum_disc_price"},
+                                          {AF::Sum, "charge", "sum_charge"},
+                                          {AF::Avg, "l_quantity", "avg_qty"},
+                                          {AF::Avg, "l_extendedprice", "avg_price"},
+                                          {AF::Avg, "l_discount", "avg_disc"},
+                                          {AF::Count, nullptr, "count_order"}});
+            return order(db, result, {{"l_returnflag", false}, {"l_linestatus", false}});
+        }
+
+        // Q3: приоритет отгрузки — три таблицы, top-10 по выручке
+        ResultSet q3(const Database& db) {
+            Plan customers = scan(db, "customer", {"c_custkey"}, {{"c_mktsegment", CompareOp::Eq, text("BUILDING")}});
+            Plan orders = scan(db, "orders", {"o_orderkey", "o_custkey", "o_orderdate", "o_shippriority"},
+                               {{"o_orderdate", CompareOp::Lt, i64(19950315)}});
+            Plan lines = scan(db, "lineitem", {"l_orderkey", "l_extendedprice", "l_discount"},
+                              {{"l_shipdate", CompareOp::Gt, i64(19950315)}});
+            ResultSet rows = run(db, join(std::move(lines), "l_orderkey",
+                                          join(std::move(orders), "o_custkey", std::move(customers), "c_custkey"),
+                                          "o_orderkey"));
+            deriveRevenue(rows);
+            ResultSet result = aggregate(db, rows, {"l_orderkey", "o_orderdate", "o_shippriority"},
+                                         {{AF::Sum, "revenue", "revenue"}});
+            return order(db, result, {{"revenue", true}, {"o_orderdate", false}}, 10);
+        }
+
+        // Q4: приоритеты заказов — EXISTS как join с уникальными ключами
+        ResultSet q4(const Database& db) {
+            ResultSet late = run(db, scan(db, "lineitem", {"l_orderkey", "l_commitdate", "l_receiptdate"},
+                                          {{"l_receiptdate", CompareOp::Ge, i64(19930701)},
+                                           {"l_receiptdate", CompareOp::Lt, i64(addDays(19931001, 152))}}));
+            const size_t commit = col(late, "l_commitdate");
+            const size_t receipt = col(late, "l_receiptdate");
+            keep(late, [=](const Row& r) { return int64(r, commit) < int64(r, receipt); });
+            const ResultSet late_orders = aggregate(db, late, {"l_orderkey"}, {{AF::Count, nullptr, "lines"}});
+            ResultSet rows = run(db, join(scan(db, "orders", {"o_orderkey", "o_orderpriority"},
+                                               {{"o_orderdate", CompareOp::Ge, i64(19930701)},
+                                                {"o_orderdate", CompareOp::Lt, i64(19931001)}}),
+                                          "o_orderkey", scan(late_orders), "l_orderkey"));
+            ResultSet result = aggregate(db, rows, {"o_orderpriority"}, {{AF::Count, nullptr, "order_count"}});
+            return order(db, result, {{"o_orderpriority", false}});
+        }
+
+        // Q5: объём местных поставщиков — цепочка из шести таблиц
+        ResultSet q5(const Database& db) {
+            Plan nations = join(scan(db, "nation", {"n_nationkey", "n_name", "n_regionkey"}), "n_regionkey",
+                                scan(db, "region", {"r_regionkey"}, {{"r_name", CompareOp::Eq, text("ASIA")}}),
+                                "r_regionkey");
+            Plan customers = join(scan(db, "customer", {"c_custkey", "c_nationkey"}), "c_nationkey",
+                                  std::move(nations), "n_nationkey");
+            Plan orders = join(scan(db, "orders", {"o_orderkey", "o_custkey"},
+                                    {{"o_orderdate", CompareOp::Ge, i64(19940101)},
+                                     {"o_orderdate", CompareOp::Lt, i64(19950101)}}),
+                               "o_custkey", std::move(customers), "c_custkey");
+            Plan lines = join(scan(db, "lineitem", {"l_orderkey", "l_suppkey", "l_extendedprice", "l_discount"}),
+                              "l_orderkey", std::move(orders), "o_orderkey");
+            ResultSet rows = run(db, join(std::move(lines), "l_suppkey",
+                                          scan(db, "supplier", {"s_suppkey", "s_nationkey"}), "s_suppkey"));
+            const size_t c_nation = col(rows, "c_nationkey");
+            const size_t s_nation = col(rows, "s_nationkey");
+            keep(rows, [=](const Row& r) { return int64(r, c_nation) == int64(r, s_nation); });
+            deriveRevenue(rows);
+            ResultSet result = aggregate(db, rows, {"n_name"}, {{AF::Sum, "revenue", "revenue"}});
+            return order(db, result, {{"revenue", true}});
+        }
+
+        // Q6: прогноз выручки — один скан с пятью предикатами
+        ResultSet q6(const Database& db) {
+            ResultSet rows = run(db, scan(db, "lineitem", {"l_extendedprice", "l_discount"},
+                                          {{"l_shipdate", CompareOp::Ge, i64(19940101)},
+                                           {"l_shipdate", CompareOp::Lt, i64(19950101)},
+                                           {"l_discount", CompareOp::Ge, 0.05},
+                                           {"l_discount", CompareOp::Le, 0.07},
+                                           {"l_quantity", CompareOp::Lt, i64(24)}}));
+            const size_t price = col(rows, "l_extendedprice");
+            const size_t discount = col(rows, "l_discount");
+            derive(rows, "gain", [=](const Row& r) { return num(r, price) * num(r, discount); });
+            return aggregate(db, rows, {}, {{AF::Sum, "gain", "revenue"}});
+        }
+
+        // Q7: объём поставок между двумя странами — nation дважды, под разными именами
+        ResultSet q7(const Database& db) {
+            auto nationSide = [&](const char* table, const char* key, const char* nation_key, const char* alias) {
+                ResultSet side = run(db, join(scan(db, table, {key, nation_key}), nation_key,
+                                              scan(db, "nation", {"n_nationkey", "n_name"}), "n_nationkey"));
+                rename(side, "n_name", alias);
+                const size_t name = col(side, alias);
+                keep(side, [=](const Row& r) { return oneOf(str(r, name), {"FRANCE", "GERMANY"}); });
+                return side;
+            };
+            const ResultSet suppliers = nationSide("supplier", "s_suppkey", "s_nationkey", "supp_nation");
+            const ResultSet customers = nationSide("customer", "c_custkey", "c_nationkey", "cust_nation");
+            Plan lines = join(scan(db, "lineitem", {"l_orderkey", "l_suppkey", "l_extendedprice", "l_discount",
+                                                    "l_shipdate"},
+                                   {{"l_shipdate", CompareOp::Ge, i64(19950101)},
+                                    {"l_shipdate", CompareOp::Le, i64(19961231)}}),
+                              "l_suppkey", scan(suppliers), "s_suppkey");
+            Plan orders = join(scan(db, "orders", {"o_orderkey", "o_custkey"}), "o_custkey", scan(customers),
+                               "c_custkey");
+            ResultSet rows = run(db, join(std::move(lines), "l_orderkey", std::move(orders), "o_orderkey"));
+            const size_t supp = col(rows, "supp_nation");
+            const size_t cust = col(rows, "cust_nation");
+            keep(rows, [=](const Row& r) { return str(r, supp) != str(r, cust); });
+            const size_t ship = col(rows, "l_shipdate");
+            derive(rows, "l_year", [=](const Row& r) { return int64(r, ship) / 10000; });
+            deriveRevenue(rows, "volume");
+            ResultSet result = aggregate(db, rows, {"supp_nation", "cust_nation", "l_year"},
+                                         {{AF::Sum, "volume", "revenue"}});
+            return order(db, result, {{"supp_nation", false}, {"cust_nation", false}, {"l_year", false}});
+        }
+
+        // Q9: прибыль по видам товаров — пять join'ов, partsupp по составному ключу
+        ResultSet q9(const Database& db) {
+            ResultSet green = run(db, scan(db, "part", {"p_partkey", "p_name"}));
+            const size_t name = col(green, "p_name");
+            keep(green, [=](const Row& r) { return str(r, name).find("green") != std::string::npos; });
+            Plan supply = join(scan(db, "partsupp", {"ps_partkey", "ps_suppkey", "ps_supplycost"}), "ps_partkey",
+                               scan(green), "p_partkey");
+            Plan suppliers = join(scan(db, "supplier", {"s_suppkey", "s_nationkey"}), "s_nationkey",
+                                  scan(db, "nation", {"n_nationkey", "n_name"}), "n_nationkey");
+            Plan lines = join(scan(db, "lineitem", {"l_orderkey", "l_partkey", "l_suppkey", "l_quantity",
+                                                    "l_extendedprice", "l_discount"}),
+                              "l_partkey", scan(green), "p_partkey");
+            lines = join(std::move(lines), "l_suppkey", std::move(suppliers), "s_suppkey");
+            lines = join(std::move(lines), "l_orderkey", scan(db, "orders", {"o_orderkey", "o_orderdate"}),
+                         "o_orderkey");
+            ResultSet rows = run(db, join(std::move(lines), "l_partkey", std::move(supply), "ps_partkey"));
+            const size_t l_supp = col(rows, "l_suppkey");
+            const size_t ps_supp = col(rows, "ps_suppkey");
+            keep(rows, [=](const Row& r) { return int64(r, l_supp) == int64(r, ps_supp); });
+            const size_t date = col(rows, "o_orderdate");
+            const size_t price = col(rows, "l_extendedprice");
+            const size_t discount = col(rows, "l_discount");
+            const size_t cost = col(rows, "ps_supplycost");
+            const size_t quantity = col(rows, "l_quantity");
+            derive(rows, "o_year", [=](const Row& r) { return int64(r, date) / 10000; });
+            derive(rows, "amount", [=](const Row& r) {
+                return num(r, price) * (1 - num(r, discount)) - num(r, cost) * num(r, quantity);
+            });
+            ResultSet result = aggregate(db, rows, {"n_name", "o_year"}, {{AF::Sum, "amount", "sum_profit"}});
+            return order(db, result, {{"n_name", false}, {"o_year", true}});
+        }
+
+        // Q10: возвраты — top-20 покупателей по потерянной выручке
+        ResultSet q10(const Database& db) {
+            Plan lines = join(scan(db, "lineitem", {"l_orderkey", "l_extendedprice", "l_discount"},
+                                   {{"l_returnflag", CompareOp::Eq, text("R")}}),
+                              "l_orderkey",
+                              scan(db, "orders", {"o_orderkey", "o_custkey"},
+                                   {{"o_orderdate", CompareOp::Ge, i64(19931001)},
+                                    {"o_orderdate", CompareOp::Lt, i64(19940101)}}),
+                              "o_orderkey");
+            Plan customers = join(scan(db, "customer", {"c_custkey", "c_name", "c_acctbal", "c_nationkey"}),
+                                  "c_nationkey", scan(db, "nation", {"n_nationkey", "n_name"}), "n_nationkey");
+            ResultSet rows = run(db, join(std::move(lines), "o_custkey", std::move(customers), "c_custkey"));
+            deriveRevenue(rows);
+            ResultSet result = aggregate(db, rows, {"c_custkey", "c_name", "c_acctbal", "n_name"},
+                                         {{AF::Sum, "revenue", "revenue"}});
+            return order(db, result, {{"revenue", true}}, 20);
+        }
+
+        // Q11: важные запасы — агрегат, отфильтрованный по доле от общего итога
+        ResultSet q11(const Database& db) {
+            Plan suppliers = join(scan(db, "supplier", {"s_suppkey", "s_nationkey"}), "s_nationkey",
+                                  scan(db, "nation", {"n_nationkey"}, {{"n_name", CompareOp::Eq, text("GERMANY")}}),
+                                  "n_nationkey");
+            ResultSet rows = run(db, join(scan(db, "partsupp", {"ps_partkey", "ps_suppkey", "ps_availqty",
+                                                                "ps_supplycost"}),
+                                          "ps_suppkey", std::move(suppliers), "s_suppkey"));
+            const size_t cost = col(rows, "ps_supplycost");
+            const size_t available = col(rows, "ps_availqty");
+            derive(rows, "stock", [=](const Row& r) { return num(r, cost) * num(r, available); });
+            const ResultSet total = aggregate(db, rows, {}, {{AF::Sum, "stock", "total"}});
+            const double threshold = isNull(total.rows.at(0)[0]) ? 0 : num(total.rows[0], 0) * 0.0001 / db.scale;
+            ResultSet result = aggregate(db, rows, {"ps_partkey"}, {{AF::Sum, "stock", "value"}});
+            const size_t value = col(result, "value");
+            keep(result, [=](const Row& r) { return num(r, value) > threshold; });
+            return order(db, result, {{"value", true}});
+        }
+
+        // Q12: способы доставки — условия между колонками после скана, CASE как производная колонка
+        ResultSet q12(const Database& db) {
+            ResultSet lines = run(db, scan(db, "lineitem",
+                                           {"l_orderkey", "l_shipmode", "l_shipdate", "l_commitdate", "l_receiptdate"},
+                                           {{"l_receiptdate", CompareOp::Ge, i64(19940101)},
+                                            {"l_receiptdate", CompareOp::Lt, i64(19950101)}}));
+            const size_t mode = col(lines, "l_shipmode");
+            const size_t ship = col(lines, "l_shipdate");
+            const size_t commit = col(lines, "l_commitdate");
+            const size_t receipt = col(lines, "l_receiptdate");
+            keep(lines, [=](const Row& r) {
+                return oneOf(str(r, mode), {"MAIL", "SHIP"}) && int64(r, commit) < int64(r, receipt) &&
+                       int64(r, ship) < int64(r, commit);
+            });
+            ResultSet rows = run(db, join(scan(db, "orders", {"o_orderkey", "o_orderpriority"}), "o_orderkey",
+                                          scan(lines), "l_orderkey"));
+            const size_t priority = col(rows, "o_orderpriority");
+            derive(rows, "high", [=](const Row& r) { return i64(oneOf(str(r, priority), {"1-URGENT", "2-HIGH"})); });
+            derive(rows, "low", [=](const Row& r) { return i64(!oneOf(str(r, priority), {"1-URGENT", "2-HIGH"})); });
+            ResultSet result = aggregate(db, rows, {"l_shipmode"},
+                                         {{AF::Sum, "high", "high_line_count"}, {AF::Sum, "low", "low_line_count"}});
+            return order(db, result, {{"l_shipmode", false}});
+        }
+
+        // Q13: распределение покупателей по числу заказов — агрегат над агрегатом;
+        // покупатели без заказов (LEFT JOIN) досчитываются по размеру таблицы
+        ResultSet q13(const Database& db) {
+            const ResultSet orders = run(db, scan(db, "orders", {"o_custkey"}));
+            const ResultSet per_customer = aggregate(db, orders, {"o_custkey"}, {{AF::Count, nullptr, "c_count"}});
+            ResultSet result = aggregate(db, per_customer, {"c_count"}, {{AF::Count, nullptr, "custdist"}});
+            const size_t customers = db.tables.getTable("customer")->rowCount();
+            if (customers > per_customer.rows.size()) {
+                result.rows.push_back({int64_t{0}, static_cast<int64_t>(customers - per_customer.rows.size())});
+            }
+            return order(db, result, {{"custdist", true}, {"c_count", true}});
+        }
+
+        // Q14: эффект промо-акции — доля выручки по условию, один итоговый ряд
+        ResultSet q14(const Database& db) {
+            ResultSet rows = run(db, join(scan(db, "lineitem", {"l_partkey", "l_extendedprice", "l_discount"},
+                                               {{"l_shipdate", CompareOp::Ge, i64(19950901)},
+                                                {"l_shipdate", CompareOp::Lt, i64(19951001)}}),
+                                          "l_partkey", scan(db, "part", {"p_partkey", "p_type"}), "p_partkey"));
+            deriveRevenue(rows);
+            const size_t type = col(rows, "p_type");
+            const size_t revenue = col(rows, "revenue");
+            derive(rows, "promo", [=](const Row& r) {
+                return str(r, type).compare(0, 5, "PROMO") == 0 ? num(r, revenue) : 0.0;
+            });
+            ResultSet result = aggregate(db, rows, {}, {{AF::Sum, "promo", "promo"}, {AF::Sum, "revenue", "total"}});
+            derive(result, "promo_revenue", [](const Row& r) -> Value {
+                if (isNull(r[0]) || isNull(r[1]) || num(r, 1) == 0) return std::monostate{};
+                return 100.0 * num(r, 0) / num(r, 1);
+            });
+            return result;
+        }
+
+        // Q15: лучший поставщик — агрегат, его максимум и join обратно
+        ResultSet q15(const Database& db) {
+            ResultSet lines = run(db, scan(db, "lineitem", {"l_suppkey", "l_extendedprice", "l_discount"},
+                                           {{"l_shipdate", CompareOp::Ge, i64(19960101)},
+                                            {"l_shipdate", CompareOp::Lt, i64(19960401)}}));
+            deriveRevenue(lines);
+            ResultSet revenue = aggregate(db, lines, {"l_suppkey"}, {{AF::Sum, "revenue", "total_revenue"}});
+            const size_t total = col(revenue, "total_revenue");
+            double best = 0;
+            for (const Row& r : revenue.rows) best = std::max(best, num(r, total));
+            keep(revenue, [=](const Row& r) { return num(r, total) == best; });
+            ResultSet rows = run(db, join(scan(db, "supplier", {"s_suppkey", "s_name"}), "s_suppkey", scan(revenue),
+                                          "l_suppkey"));
+            return order(db, rows, {{"s_suppkey", false}});
+        }
+
+        // Q17: выручка от мелких заказов — коррелированный подзапрос как агрегат и второй join
+        ResultSet q17(const Database& db) {
+            ResultSet rows = run(db, join(scan(db, "lineitem", {"l_partkey", "l_quantity", "l_extendedprice"}),
+                                          "l_partkey",
+                                          scan(db, "part", {"p_partkey"},
+                                               {{"p_brand", CompareOp::Eq, text("Brand#23")},
+                                                {"p_container", CompareOp::Eq, text("MED BOX")}}),
+                                          "p_partkey"));
+            ResultSet average = aggregate(db, rows, {"l_partkey"}, {{AF::Avg, "l_quantity", "avg_qty"}});
+            rename(average, "l_partkey", "avg_partkey");
+            ResultSet joined = run(db, join(scan(rows), "l_partkey", scan(average), "avg_partkey"));
+            const size_t quantity = col(joined, "l_quantity");
+            const size_t avg = col(joined, "avg_qty");
+            keep(joined, [=](const Row& r) { return num(r, quantity) < 0.2 * num(r, avg); });
+            ResultSet result = aggregate(db, joined, {}, {{AF::Sum, "l_extendedprice", "sum_price"}});
+            derive(result, "avg_yearly", [](const Row& r) -> Value {
+                if (isNull(r[0])) return std::monostate{};
+                return num(r, 0) / 7.0;
+            });
+            return result;
+        }
+
+        // Q18: крупные покупатели — HAVING над агрегатом всей lineitem, top-100
+        ResultSet q18(const Database& db) {
+            const ResultSet lines = run(db, scan(db, "lineitem", {"l_orderkey", "l_quantity"}));
+            ResultSet large = aggregate(db, lines, {"l_orderkey"}, {{AF::Sum, "l_quantity", "sum_qty"}});
+            const size_t quantity = col(large, "sum_qty");
+            keep(large, [=](const Row& r) { return num(r, quantity) > 300; });
+            Plan orders = join(scan(db, "orders", {"o_orderkey", "o_custkey", "o_orderdate", "o_totalprice"}),
+                               "o_orderkey", scan(large), "l_orderkey");
+            ResultSet rows = run(db, join(std::move(orders), "o_custkey",
+                                          scan(db, "customer", {"c_custkey", "c_name"}), "c_custkey"));
+            return order(db, rows, {{"o_totalprice", true}, {"o_orderdate", false}}, 100);
+        }
+
+        // Q19: скидочная выручка — дизъюнкция из трёх наборов условий после join
+        ResultSet q19(const Database& db) {
+            ResultSet lines = run(db, scan(db, "lineitem",
+                                           {"l_partkey", "l_quantity", "l_extendedprice", "l_discount", "l_shipmode"},
+                                           {{"l_shipinstruct", CompareOp::Eq, text("DELIVER IN PERSON")},
+                                            {"l_quantity", CompareOp::Ge, i64(1)},
+                                            {"l_quantity", CompareOp::Le, i64(30)}}));
+            const size_t mode = col(lines, "l_shipmode");
+            keep(lines, [=](const Row& r) { return oneOf(str(r, mode), {"AIR", "REG AIR"}); });
+            ResultSet rows = run(db, join(scan(lines), "l_partkey",
+                                          scan(db, "part", {"p_partkey", "p_brand", "p_container", "p_size"}),
+                                          "p_partkey"));
+            const size_t brand = col(rows, "p_brand");
+            const size_t container = col(rows, "p_container");
+            const size_t size = col(rows, "p_size");
+            const size_t quantity = col(rows, "l_quantity");
+            keep(rows, [=](const Row& r) {
+                const int64_t q = int64(r, quantity);
+                const int64_t s = int64(r, size);
+                const std::string& c = str(r, container);
+                return (str(r, brand) == "Brand#12" && oneOf(c, {"SM CASE", "SM BOX", "SM PACK", "SM PKG"}) &&
+                        q >= 1 && q <= 11 && s >= 1 && s <= 5) ||
+                       (str(r, brand) == "Brand#23" && oneOf(c, {"MED BAG", "MED BOX", "MED PKG", "MED PACK"}) &&
+                        q >= 10 && q <= 20 && s >= 1 && s <= 10) ||
+                       (str(r, brand) == "Brand#34" && oneOf(c, {"LG CASE", "LG BOX", "LG PACK", "LG PKG"}) &&
+                        q >= 20 && q <= 30 && s >= 1 && s <= 15);
+            });
+            deriveRevenue(rows);
+            return aggregate(db, rows, {}, {{AF::Sum, "revenue", "revenue"}});
+        }
+    }
+
+    const std::vector<Query>& queries() {
+        static const std::vector<Query> all = {
+            {1, "pricing summary report", q1},
+            {3, "shipping priority", q3},
+            {4, "order priority checking", q4},
+            {5, "local supplier volume", q5},
+            {6, "forecasting revenue change", q6},
+            {7, "volume shipping", q7},
+            {9, "product type profit", q9},
+            {10, "returned item reporting", q10},
+            {11, "important stock identification", q11},
+            {12, "shipping modes and order priority", q12},
+            {13, "customer distribution", q13},
+            {14, "promotion effect", q14},
+            {15, "top supplier", q15},
+            {17, "small-quantity-order revenue", q17},
+            {18, "large volume customer", q18},
+            {19, "discounted revenue", q19},
+        };
+        return all;
+    }
+}
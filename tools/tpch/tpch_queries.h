@@ -0,0 +1,29 @@
+#pragma once
+#include "query_engine/executor.h"
+#include "storage_engine/table_manager.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Tpch {
+    // Всё, что нужно запросу. Контекст — один на прогон, как у запроса из сети:
+    // общий бюджет памяти и отмена на все операторы.
+    struct Database {
+        const QueryExecutor& executor;
+        const TableManager& tables;
+        double scale;
+        std::shared_ptr<QueryContext> ctx;
+    };
+
+    // Форма запроса TPC-H, собранная из операторов QueryExecutor: сканы с
+    // предикатами, hash join, агрегация, сортировка и top-N. Выражения над
+    // колонками и условия, которых нет в ColumnPredicate (OR, LIKE, сравнение
+    // двух колонок), считаются между операторами, как это делал бы Filter/Project.
+    struct Query {
+        int number; // номер запроса TPC-H
+        const char* title;
+        std::function<ResultSet(const Database&)> run;
+    };
+
+    const std::vector<Query>& queries();
+}
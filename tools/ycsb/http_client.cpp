@@ -0,0 +1,111 @@
+#include "http_client.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <istream>
+#include <stdexcept>
+
+namespace Ycsb {
+    namespace {
+        std::string lower(std::string text) {
+            std::transform(text.begin(), text.end(), text.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return text;
+        }
+
+        std::string trim(const std::string& text) {
+            const size_t begin = text.find_first_not_of(" \t");
+            if (begin == std::string::npos) return "";
+            return text.substr(begin, text.find_last_not_of(" \t") - begin + 1);
+        }
+    }
+
+    HttpClient::HttpClient(std::string host, unsigned short port,
+                           std::vector<std::pair<std::string, std::string>> headers)
+        : host_(std::move(host)), port_(port), headers_(std::move(headers)), socket_(io_) {}
+
+    void HttpClient::connect() {
+        asio::ip::tcp::resolver resolver(io_);
+        asio::connect(socket_, resolver.resolve(host_, std::to_string(port_)));
+        socket_.set_option(asio::ip::tcp::no_delay(true));
+        buffer_.consume(buffer_.size());
+    }
+
+    HttpResponse HttpClient::post(const std::string& path, const std::string& content_type,
+                                  const std::string& body) {
+        std::string head = "POST " + path + " HTTP/1.1\r\nHost: " + host_ + "\r\nContent-Type: " + content_type +
+                           "\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+        for (const auto& [name, value] : headers_) head += name + ": " + value + "\r\n";
+        head += "\r\n";
+        // Сервер мог закрыть простаивающее соединение: тогда один повтор на новом
+        for (int attempt = 0;; ++attempt) {
+            const bool reused = socket_.is_open();
+            if (!reused) connect();
+            try {
+                asio::write(socket_, std::vector<asio::const_buffer>{asio::buffer(head), asio::buffer(body)});
+                return readResponse();
+            } catch (const asio::system_error& e) {
+                asio::error_code ignored;
+                socket_.close(ignored);
+                const bool closed_idle = e.code() == asio::error::eof || e.code() == asio::error::connection_reset ||
+                                         e.code() == asio::error::broken_pipe;
+                if (!reused || !closed_idle || attempt > 0) throw;
+            }
+        }
+    }
+
+    std::string HttpClient::readLine() {
+        asio::read_until(socket_, buffer_, "\r\n");
+        std::istream in(&buffer_);
+        std::string line;
+        std::getline(in, line);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        return line;
+    }
+
+    void HttpClient::readExactly(size_t size, std::string& out) {
+        if (buffer_.size() < size) asio::read(socket_, buffer_, asio::transfer_exactly(size - buffer_.size()));
+        const char* data = static_cast<const char*>(buffer_.data().data());
+        out.append(data, size);
+        buffer_.consume(size);
+    }
+
+    HttpResponse HttpClient::readResponse() {
+        HttpResponse response;
+        const std::string status_line = readLine();
+        // HTTP/1.1 200 OK
+        if (status_line.compare(0, 5, "HTTP/") != 0 || status_line.size() < 12) {
+            throw std::runtime_error("Malformed status line: " + status_line);
+        }
+        response.status = std::atoi(status_line.c_str() + 9);
+
+        size_t content_length = 0;
+        bool chunked = false;
+        bool close = false;
+        for (std::string line; !(line = readLine()).empty();) {
+            const size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            const std::string name = lower(line.substr(0, colon));
+            const std::string value = trim(line.substr(colon + 1));
+            if (name == "content-length") content_length = std::strtoull(value.c_str(), nullptr, 10);
+            if (name == "transfer-encoding") chunked = lower(value) == "chunked";
+            if (name == "connection") close = lower(value) == "close";
+        }
+
+        if (!chunked) {
+            readExactly(content_length, response.body);
+        } else {
+            for (;;) {
+                const size_t size = std::strtoull(readLine().c_str(), nullptr, 16);
+                if (size == 0) {
+                    readLine(); // пустая строка после последнего chunk
+                    break;
+                }
+                readExactly(size, response.body);
+                readLine();
+            }
+        }
+        if (close) socket_.close();
+        return response;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <asio.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Ycsb {
+    struct HttpResponse {
+        int status = 0;
+        std::string body;
+    };
+
+    // Синхронный HTTP/1.1-клиент на одно keep-alive соединение; один поток на
+    // клиента. Понимает Content-Length и chunked, сжатие не запрашивает.
+    // Сетевые ошибки — asio::system_error; следующий запрос переподключается.
+    class HttpClient {
+    public:
+        HttpClient(std::string host, unsigned short port,
+                   std::vector<std::pair<std::string, std::string>> headers = {});
+
+        HttpResponse post(const std::string& path, const std::string& content_type, const std::string& body);
+
+    private:
+        void connect();
+        HttpResponse readResponse();
+        std::string readLine();
+        void readExactly(size_t size, std::string& out);
+
+        std::string host_;
+        unsigned short port_;
+        std::vector<std::pair<std::string, std::string>> headers_;
+        asio::io_context io_;
+        asio::ip::tcp::socket socket_;
+        asio::streambuf buffer_;
+    };
+}
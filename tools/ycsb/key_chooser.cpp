@@ -0,0 +1,57 @@
+#include "key_chooser.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Ycsb {
+    namespace {
+        // FNV-1a по байтам ранга: разносит соседние ранги далеко друг от друга
+        uint64_t fnv64(uint64_t value) {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (int i = 0; i < 8; ++i) {
+                hash ^= value & 0xff;
+                hash *= 0x100000001b3ull;
+                value >>= 8;
+            }
+            return hash;
+        }
+    }
+
+    ZipfianGenerator::ZipfianGenerator(uint64_t items, double theta)
+        : theta_(theta), alpha_(1.0 / (1.0 - theta)), zeta2_(1.0 + std::pow(0.5, theta)) {
+        grow(std::max<uint64_t>(items, 1));
+    }
+
+    void ZipfianGenerator::grow(uint64_t items) {
+        if (items <= items_) return;
+        for (uint64_t i = items_ + 1; i <= items; ++i) zetan_ += 1.0 / std::pow(static_cast<double>(i), theta_);
+        items_ = items;
+        eta_ = (1.0 - std::pow(2.0 / static_cast<double>(items_), 1.0 - theta_)) / (1.0 - zeta2_ / zetan_);
+    }
+
+    uint64_t ZipfianGenerator::next(std::mt19937_64& rng) {
+        const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        const double uz = u * zetan_;
+        if (uz < 1.0) return 0;
+        if (uz < zeta2_) return std::min<uint64_t>(1, items_ - 1);
+        const auto rank = static_cast<uint64_t>(static_cast<double>(items_) * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+        return std::min(rank, items_ - 1);
+    }
+
+    KeyChooser::KeyChooser(Distribution distribution, uint64_t records)
+        : distribution_(distribution), zipfian_(distribution == Distribution::Uniform ? 1 : records) {}
+
+    uint64_t KeyChooser::next(std::mt19937_64& rng, uint64_t key_count) {
+        key_count = std::max<uint64_t>(key_count, 1);
+        switch (distribution_) {
+            case Distribution::Uniform:
+                return std::uniform_int_distribution<uint64_t>(0, key_count - 1)(rng);
+            case Distribution::Zipfian:
+                zipfian_.grow(key_count);
+                return fnv64(zipfian_.next(rng)) % key_count;
+            case Distribution::Latest:
+                zipfian_.grow(key_count);
+                return key_count - 1 - zipfian_.next(rng);
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <random>
+
+namespace Ycsb {
+    // Параметр распределения Зипфа, как у YCSB
+    constexpr double kZipfianTheta = 0.99;
+
+    // Ранги [0, items) по Зипфу: 0 — самый частый. Алгоритм Gray et al.,
+    // "Quickly generating billion-record synthetic databases", как в YCSB.
+    // items может только расти; zeta досчитывается по новым рангам.
+    class ZipfianGenerator {
+    public:
+        explicit ZipfianGenerator(uint64_t items, double theta = kZipfianTheta);
+
+        uint64_t next(std::mt19937_64& rng);
+        void grow(uint64_t items);
+
+    private:
+        uint64_t items_ = 0;
+        double theta_;
+        double alpha_;
+        double zeta2_;
+        double zetan_ = 0;
+        double eta_ = 0;
+    };
+
+    enum class Distribution { Uniform, Zipfian, Latest };
+
+    // Выбор существующего ключа для чтения, обновления и начала скана.
+    // Zipfian — популярные ключи перемешаны по всему пространству (scrambled),
+    // Latest — популярнее всего недавно вставленные.
+    class KeyChooser {
+    public:
+        KeyChooser(Distribution distribution, uint64_t records);
+
+        // key_count — ключей в таблице сейчас, растёт со вставками
+        uint64_t next(std::mt19937_64& rng, uint64_t key_count);
+
+    private:
+        Distribution distribution_;
+        ZipfianGenerator zipfian_;
+    };
+}
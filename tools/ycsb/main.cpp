@@ -0,0 +1,370 @@
+#include "common/metrics.h"
+#include "http_client.h"
+#include "key_chooser.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Нагрузка YCSB A–F на POST /api/query из множества keep-alive соединений.
+// UPDATE в движке нет, поэтому обновление — вставка новой версии строки,
+// а чтение берёт последнюю: WHERE ycsb_key = ? ORDER BY version DESC LIMIT 1.
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using Ycsb::Distribution;
+
+    enum class Op { Read, Update, Scan, Insert, ReadModifyWrite };
+    constexpr size_t kOpCount = 5;
+    constexpr std::array<const char*, kOpCount> kOpNames = {"READ", "UPDATE", "SCAN", "INSERT", "READ-MODIFY-WRITE"};
+
+    // Доли операций — как в стандартных workloads YCSB
+    struct Workload {
+        char name;
+        const char* title;
+        std::array<double, kOpCount> mix; // в порядке Op
+        Distribution distribution;
+    };
+
+    constexpr std::array<Workload, 6> kWorkloads = {{
+        {'A', "update heavy", {0.5, 0.5, 0, 0, 0}, Distribution::Zipfian},
+        {'B', "read mostly", {0.95, 0.05, 0, 0, 0}, Distribution::Zipfian},
+        {'C', "read only", {1, 0, 0, 0, 0}, Distribution::Zipfian},
+        {'D', "read latest", {0.95, 0, 0, 0.05, 0}, Distribution::Latest},
+        {'E', "short ranges", {0, 0, 0.95, 0.05, 0}, Distribution::Zipfian},
+        {'F', "read-modify-write", {0.5, 0, 0, 0, 0.5}, Distribution::Zipfian},
+    }};
+
+    // Строк в одном INSERT при загрузке
+    constexpr uint64_t kLoadBatch = 100;
+
+    struct Options {
+        std::string host = "127.0.0.1";
+        unsigned short port = 8080;
+        std::vector<const Workload*> workloads;
+        std::string table = "usertable";
+        uint64_t records = 100000;
+        uint64_t operations = 100000;
+        std::chrono::seconds duration{0};
+        size_t connections = 32;
+        size_t fields = 10;
+        size_t field_length = 100;
+        uint64_t max_scan_length = 100;
+        bool load = true;
+        std::string workload_class;
+        uint64_t seed = 42;
+    };
+
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "  --host HOST            server address (default 127.0.0.1)\n"
+                  << "  --port N               server HTTP port (default 8080)\n"
+                  << "  --workload LIST        comma-separated YCSB workloads A-F, run in order (default A)\n"
+                  << "  --records N            rows loaded before the run (default 100000)\n"
+                  << "  --operations N         operations per workload (default 100000)\n"
+                  << "  --duration S           stop a workload after S seconds, 0 = no limit (default 0)\n"
+                  << "  --connections N        concurrent keep-alive connections (default 32)\n"
+                  << "  --fields N             text fields per row (default 10)\n"
+                  << "  --field-length N       bytes per field (default 100)\n"
+                  << "  --max-scan-length N    longest scan in workload E (default 100)\n"
+                  << "  --table NAME           table to create and query (default usertable)\n"
+                  << "  --skip-load            use a table loaded by an earlier run\n"
+                  << "  --workload-class NAME  X-Workload-Class header for every request\n"
+                  << "  --seed N               random seed (default 42)\n";
+    }
+
+    unsigned long long parseNumber(const std::string& option, const char* text) {
+        char* end = nullptr;
+        const unsigned long long value = std::strtoull(text, &end, 10);
+        if (end == text || *end != '\0' || text[0] == '-') {
+            throw std::invalid_argument("Invalid value for " + option + ": " + text);
+        }
+        return value;
+    }
+
+    std::vector<const Workload*> parseWorkloads(const std::string& list) {
+        std::vector<const Workload*> workloads;
+        for (char c : list) {
+            if (c == ',') continue;
+            const char name = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            auto it = std::find_if(kWorkloads.begin(), kWorkloads.end(), [&](const Workload& w) { return w.name == name; });
+            if (it == kWorkloads.end()) throw std::invalid_argument("Unknown workload " + std::string(1, c));
+            workloads.push_back(&*it);
+        }
+        if (workloads.empty()) throw std::invalid_argument("No workload in --workload " + list);
+        return workloads;
+    }
+
+    Options parseArgs(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            const std::string option = argv[i];
+            if (option == "--skip-load") {
+                options.load = false;
+                continue;
+            }
+            if (option == "--help" || option == "-h") {
+                printUsage(argv[0]);
+                std::exit(0);
+            }
+            const bool known = option == "--host" || option == "--port" || option == "--workload" ||
+                               option == "--records" || option == "--operations" || option == "--duration" ||
+                               option == "--connections" || option == "--fields" || option == "--field-length" ||
+                               option == "--max-scan-length" || option == "--table" ||
+                               option == "--workload-class" || option == "--seed";
+            if (!known) throw std::invalid_argument("Unknown option " + option);
+            if (i + 1 == argc) throw std::invalid_argument("Missing value for " + option);
+            const char* value = argv[++i];
+            if (option == "--host") {
+                options.host = value;
+            } else if (option == "--port") {
+                const unsigned long long port = parseNumber(option, value);
+                if (port == 0 || port > 65535) throw std::invalid_argument(std::string("Invalid port ") + value);
+                options.port = static_cast<unsigned short>(port);
+            } else if (option == "--workload") {
+                options.workloads = parseWorkloads(value);
+            } else if (option == "--records") {
+                options.records = std::max<uint64_t>(1, parseNumber(option, value));
+            } else if (option == "--operations") {
+                options.operations = parseNumber(option, value);
+            } else if (option == "--duration") {
+                options.duration = std::chrono::seconds(parseNumber(option, value));
+            } else if (option == "--connections") {
+                options.connections = std::max<size_t>(1, parseNumber(option, value));
+            } else if (option == "--fields") {
+                options.fields = parseNumber(option, value);
+            } else if (option == "--field-length") {
+                options.field_length = parseNumber(option, value);
+            } else if (option == "--max-scan-length") {
+                options.max_scan_length = std::max<uint64_t>(1, parseNumber(option, value));
+            } else if (option == "--table") {
+                options.table = value;
+            } else if (option == "--workload-class") {
+                options.workload_class = value;
+            } else {
+                options.seed = parseNumber(option, value);
+            }
+        }
+        if (options.workloads.empty()) options.workloads = parseWorkloads("A");
+        return options;
+    }
+
+    // Ключи и версии, общие для всех соединений
+    struct Keyspace {
+        std::atomic<uint64_t> next_key;  // следующий ключ для INSERT
+        std::atomic<uint64_t> inserted;  // ключей подтверждено сервером
+        std::atomic<uint64_t> version{1}; // версия для очередного обновления
+    };
+
+    struct OpStats {
+        Metrics::Histogram latency;
+        std::atomic<uint64_t> errors{0};
+    };
+
+    class Session {
+    public:
+        Session(const Options& options, Keyspace& keys, uint64_t seed)
+            : options_(options), keys_(keys), rng_(seed), client_(options.host, options.port, headers(options)) {}
+
+        // false — сервер ответил ошибкой; сетевые ошибки — исключение
+        bool execute(const std::string& sql) {
+            const Ycsb::HttpResponse response = client_.post("/api/query", "text/plain", sql);
+            if (response.status != 200 && !reported_) {
+                reported_ = true;
+                std::fprintf(stderr, "HTTP %d: %.200s\n", response.status, response.body.c_str());
+            }
+            return response.status == 200;
+        }
+
+        bool createTable() {
+            std::string sql = "CREATE TABLE " + options_.table + " (ycsb_key BIGINT, version BIGINT";
+            for (size_t f = 0; f < options_.fields; ++f) sql += ", field" + std::to_string(f) + " TEXT";
+            return execute(sql + ")");
+        }
+
+        bool insert(uint64_t first_key, uint64_t count, uint64_t version) {
+            std::string sql = "INSERT INTO " + options_.table + " VALUES ";
+            for (uint64_t key = first_key; key < first_key + count; ++key) {
+                if (key != first_key) sql += ", ";
+                sql += "(" + std::to_string(key) + ", " + std::to_string(version);
+                for (size_t f = 0; f < options_.fields; ++f) sql += ", '" + randomText() + "'";
+                sql += ")";
+            }
+            return execute(sql);
+        }
+
+        bool run(Op op, Ycsb::KeyChooser& chooser) {
+            switch (op) {
+                case Op::Read:
+                    return read(chooser.next(rng_, keys_.inserted.load(std::memory_order_relaxed)));
+                case Op::Update:
+                    return update(chooser.next(rng_, keys_.inserted.load(std::memory_order_relaxed)));
+                case Op::Scan: {
+                    const uint64_t key = chooser.next(rng_, keys_.inserted.load(std::memory_order_relaxed));
+                    const uint64_t length = std::uniform_int_distribution<uint64_t>(1, options_.max_scan_length)(rng_);
+                    return execute("SELECT * FROM " + options_.table + " WHERE ycsb_key >= " + std::to_string(key) +
+                                   " ORDER BY ycsb_key LIMIT " + std::to_string(length));
+                }
+                case Op::Insert: {
+                    const uint64_t key = keys_.next_key.fetch_add(1);
+                    if (!insert(key, 1, 0)) return false;
+                    keys_.inserted.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+                case Op::ReadModifyWrite: {
+                    const uint64_t key = chooser.next(rng_, keys_.inserted.load(std::memory_order_relaxed));
+                    return read(key) && update(key);
+                }
+            }
+            return false;
+        }
+
+        Op pick(const Workload& workload) {
+            double r = std::uniform_real_distribution<double>(0.0, 1.0)(rng_);
+            for (size_t i = 0; i < kOpCount; ++i) {
+                if (r < workload.mix[i]) return static_cast<Op>(i);
+                r -= workload.mix[i];
+            }
+            // Погрешность суммы долей: последняя операция с ненулевой долей
+            for (size_t i = kOpCount; i-- > 0;) {
+                if (workload.mix[i] > 0) return static_cast<Op>(i);
+            }
+            return Op::Read;
+        }
+
+    private:
+        static std::vector<std::pair<std::string, std::string>> headers(const Options& options) {
+            if (options.workload_class.empty()) return {};
+            return {{"X-Workload-Class", options.workload_class}};
+        }
+
+        bool read(uint64_t key) {
+            return execute("SELECT * FROM " + options_.table + " WHERE ycsb_key = " + std::to_string(key) +
+                           " ORDER BY version DESC LIMIT 1");
+        }
+
+        bool update(uint64_t key) { return insert(key, 1, keys_.version.fetch_add(1, std::memory_order_relaxed)); }
+
+        // Буквы и цифры: не нужно экранировать в SQL-литерале
+        std::string randomText() {
+            static constexpr char kAlphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+            std::string text(options_.field_length, ' ');
+            for (char& c : text) c = kAlphabet[rng_() % (sizeof(kAlphabet) - 1)];
+            return text;
+        }
+
+        const Options& options_;
+        Keyspace& keys_;
+        std::mt19937_64 rng_;
+        Ycsb::HttpClient client_;
+        bool reported_ = false; // первая ошибка сервера печатается, остальные только считаются
+    };
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Загрузка records строк пачками по kLoadBatch из всех соединений
+    void load(const Options& options, Keyspace& keys) {
+        if (!Session(options, keys, options.seed).createTable()) {
+            throw std::runtime_error("Cannot create table " + options.table + ", use --skip-load if it is loaded");
+        }
+        std::atomic<uint64_t> next_batch{0};
+        std::atomic<uint64_t> errors{0};
+        const auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (size_t c = 0; c < options.connections; ++c) {
+            threads.emplace_back([&, c] {
+                Session session(options, keys, options.seed + c + 1);
+                for (uint64_t first; (first = next_batch.fetch_add(kLoadBatch)) < options.records;) {
+                    const uint64_t count = std::min(kLoadBatch, options.records - first);
+                    try {
+                        if (!session.insert(first, count, 0)) errors.fetch_add(1);
+                    } catch (const std::exception&) {
+                        errors.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        const double seconds = secondsSince(start);
+        std::printf("load: %llu records in %.1f s, %.0f records/s, %llu failed batches\n",
+                    static_cast<unsigned long long>(options.records), seconds,
+                    static_cast<double>(options.records) / seconds, static_cast<unsigned long long>(errors.load()));
+    }
+
+    void runWorkload(const Options& options, const Workload& workload, Keyspace& keys) {
+        std::array<OpStats, kOpCount> stats;
+        std::atomic<uint64_t> issued{0};
+        const auto start = Clock::now();
+        const Clock::time_point deadline =
+            options.duration.count() == 0 ? Clock::time_point::max() : start + options.duration;
+        std::vector<std::thread> threads;
+        for (size_t c = 0; c < options.connections; ++c) {
+            threads.emplace_back([&, c] {
+                Session session(options, keys, options.seed * 1000003 + workload.name * 1009 + c);
+                Ycsb::KeyChooser chooser(workload.distribution, options.records);
+                while (issued.fetch_add(1) < options.operations && Clock::now() < deadline) {
+                    const Op op = session.pick(workload);
+                    OpStats& op_stats = stats[static_cast<size_t>(op)];
+                    const auto op_start = Clock::now();
+                    bool ok = false;
+                    try {
+                        ok = session.run(op, chooser);
+                    } catch (const std::exception&) {
+                        // Соединение переоткроется следующим запросом
+                    }
+                    op_stats.latency.record(Clock::now() - op_start);
+                    if (!ok) op_stats.errors.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        const double seconds = secondsSince(start);
+
+        uint64_t total = 0;
+        for (const OpStats& s : stats) total += s.latency.snapshot().count;
+        std::printf("\n[%c] %s: %llu operations in %.1f s, %.0f ops/s over %zu connections\n", workload.name,
+                    workload.title, static_cast<unsigned long long>(total), seconds,
+                    static_cast<double>(total) / seconds, options.connections);
+        std::printf("  %-18s %10s %8s %10s %10s %10s %10s %10s\n", "operation", "count", "errors", "avg us",
+                    "p50 us", "p95 us", "p99 us", "p99.9 us");
+        for (size_t i = 0; i < kOpCount; ++i) {
+            const Metrics::Histogram::Snapshot snap = stats[i].latency.snapshot();
+            if (snap.count == 0) continue;
+            std::printf("  %-18s %10llu %8llu %10.0f %10llu %10llu %10llu %10llu\n", kOpNames[i],
+                        static_cast<unsigned long long>(snap.count),
+                        static_cast<unsigned long long>(stats[i].errors.load()),
+                        static_cast<double>(snap.sum_micros) / static_cast<double>(snap.count),
+                        static_cast<unsigned long long>(snap.quantileMicros(0.5)),
+                        static_cast<unsigned long long>(snap.quantileMicros(0.95)),
+                        static_cast<unsigned long long>(snap.quantileMicros(0.99)),
+                        static_cast<unsigned long long>(snap.quantileMicros(0.999)));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        const Options options = parseArgs(argc, argv);
+        Keyspace keys;
+        keys.next_key = options.records;
+        keys.inserted = options.records;
+        if (options.load) load(options, keys);
+        for (const Workload* workload : options.workloads) runWorkload(options, *workload, keys);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}